@@ -1,5 +1,11 @@
 #include "Json.h"
 #include "JsonValue.h"
+#include "JsonPointer.h"
+#include "JsonPath.h"
+#include "JsonColumn.h"
+#include "JsonAggregate.h"
+#include "JsonValidator.h"
+#include "JsonMinifier.h"
 #include "JsonException.h"
 namespace SJson
 {
@@ -35,11 +41,11 @@ namespace SJson
         swap(m_Value, rhs.m_Value);
     }
 
-    void Json::Parse(const std::string &content, std::string &status) noexcept
+    void Json::Parse(const std::string &content, std::string &status, int flags) noexcept
     {
         try
         {
-            Parse(content);
+            Parse(content, flags);
             status = "parse ok";
         }
         catch (const JsonException &msg)
@@ -51,9 +57,109 @@ namespace SJson
         }
     }
 
-    void Json::Parse(const std::string &content)
+    void Json::Parse(const std::string &content, int flags)
     {
-        m_Value->Parse(content);
+        m_Value->Parse(content, flags);
+    }
+
+    void Json::Parse(const std::string &content, std::string &status, JsonKeyTable &keys, int flags) noexcept
+    {
+        try
+        {
+            Parse(content, keys, flags);
+            status = "parse ok";
+        }
+        catch (const JsonException &msg)
+        {
+            status = msg.what();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void Json::Parse(const std::string &content, JsonKeyTable &keys, int flags)
+    {
+        m_Value->Parse(content, keys, flags);
+    }
+
+    bool Json::Validate(const char *data, size_t size) noexcept
+    {
+        std::string status;
+        return Validate(data, size, status);
+    }
+
+    bool Json::Validate(const char *data, size_t size, std::string &status) noexcept
+    {
+        try
+        {
+            JsonValidator(data, size);
+            status = "validate ok";
+            return true;
+        }
+        catch (const JsonException &msg)
+        {
+            status = msg.what();
+        }
+        catch (...)
+        {
+        }
+        return false;
+    }
+
+    bool Json::Minify(const char *data, size_t size, std::string &content) noexcept
+    {
+        try
+        {
+            JsonMinifier(data, size, content);
+            return true;
+        }
+        catch (...)
+        {
+        }
+        return false;
+    }
+
+    void Json::ParseCbor(const std::string &content, std::string &status) noexcept
+    {
+        try
+        {
+            ParseCbor(content);
+            status = "parse ok";
+        }
+        catch (const JsonException &msg)
+        {
+            status = msg.what();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void Json::ParseCbor(const std::string &content)
+    {
+        m_Value->ParseCbor(content);
+    }
+
+    void Json::ParseMsgPack(const std::string &content, std::string &status, int flags) noexcept
+    {
+        try
+        {
+            ParseMsgPack(content, flags);
+            status = "parse ok";
+        }
+        catch (const JsonException &msg)
+        {
+            status = msg.what();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void Json::ParseMsgPack(const std::string &content, int flags)
+    {
+        m_Value->ParseMsgPack(content, flags);
     }
 
     bool operator==(const Json &lhs, const Json &rhs) noexcept
@@ -96,14 +202,34 @@ namespace SJson
     {
         m_Value->SetNumber(d);
     }
+    const std::string Json::GetNumberText() const noexcept
+    {
+        return std::string(m_Value->GetNumberText());
+    }
     const std::string Json::GetString() const noexcept
     {
-        return m_Value->GetString();
+        return std::string(m_Value->GetString());
     }
     void Json::SetString(const std::string &str) noexcept
     {
         m_Value->SetString(str);
     }
+    void Json::SetString(std::string &&str) noexcept
+    {
+        m_Value->SetString(std::move(str));
+    }
+    const std::string Json::GetRaw() const noexcept
+    {
+        return m_Value->GetRaw();
+    }
+    void Json::SetRaw(const std::string &content) noexcept
+    {
+        m_Value->SetRaw(content);
+    }
+    void Json::SetRaw(std::string &&content) noexcept
+    {
+        m_Value->SetRaw(std::move(content));
+    }
     size_t Json::GetArraySize() const noexcept
     {
         return m_Value->GetArraySize();
@@ -111,7 +237,11 @@ namespace SJson
     Json Json::GetArrayElement(size_t index) const noexcept
     {
         Json ret;
-        ret.m_Value.reset(new JsonValue(m_Value->GetArrayElement(index)));
+        // packed 数组直接取出数字，不生成元素的 JsonValue
+        if (const double *numbers = m_Value->GetArrayNumbers())
+            ret.m_Value->SetNumber(numbers[index]);
+        else
+            ret.m_Value.reset(new JsonValue(m_Value->GetArrayElement(index)));
         return ret;
     }
     void Json::SetArray() noexcept
@@ -122,6 +252,10 @@ namespace SJson
     {
         m_Value->PushbackArrayElement(*val.m_Value);
     }
+    void Json::PushbackArrayElement(Json &&val) noexcept
+    {
+        m_Value->PushbackArrayElement(std::move(*val.m_Value));
+    }
     void Json::PopbackArrayElement() noexcept
     {
         m_Value->PopbackArrayElement();
@@ -134,13 +268,21 @@ namespace SJson
     {
         m_Value->InsertArrayElement(*val.m_Value, index);
     }
+    void Json::InsertArrayElement(Json &&val, size_t index) noexcept
+    {
+        m_Value->InsertArrayElement(std::move(*val.m_Value), index);
+    }
     void Json::ClearArray() noexcept
     {
         m_Value->ClearArray();
     }
+    void Json::ReserveArray(size_t capacity) noexcept
+    {
+        m_Value->ReserveArray(capacity);
+    }
     void Json::SetObject() noexcept
     {
-        m_Value->SetObject(std::vector<std::pair<std::string, JsonValue>>{});
+        m_Value->SetObject(std::vector<std::pair<JsonKey, JsonValue>>{});
     }
     size_t Json::GetObjectSize() const noexcept
     {
@@ -164,6 +306,14 @@ namespace SJson
     {
         m_Value->SetObjectValue(key, *val.m_Value);
     }
+    void Json::SetObjectValue(const std::string &key, Json &&val) noexcept
+    {
+        m_Value->SetObjectValue(key, std::move(*val.m_Value));
+    }
+    void Json::EmplaceObjectValue(std::string &&key, Json &&val) noexcept
+    {
+        m_Value->EmplaceObjectValue(std::move(key), std::move(*val.m_Value));
+    }
     long long Json::FindObjectIndex(const std::string &key) const noexcept
     {
         return m_Value->FindObjectIndex(key);
@@ -176,8 +326,85 @@ namespace SJson
     {
         m_Value->ClearObject();
     }
+    void Json::ReserveObject(size_t capacity) noexcept
+    {
+        m_Value->ReserveObject(capacity);
+    }
+    void Json::Patch(const Json &patch, std::string &status) noexcept
+    {
+        try
+        {
+            Patch(patch);
+            status = "patch ok";
+        }
+        catch (const JsonException &msg)
+        {
+            status = msg.what();
+        }
+        catch (...)
+        {
+        }
+    }
+    void Json::Patch(const Json &patch)
+    {
+        m_Value->Patch(*patch.m_Value);
+    }
+    void Json::MergePatch(const Json &patch) noexcept
+    {
+        m_Value->MergePatch(*patch.m_Value);
+    }
+    Json Json::Diff(const Json &target) const noexcept
+    {
+        Json patch;
+        m_Value->Diff(*target.m_Value, *patch.m_Value);
+        return patch;
+    }
+    size_t Json::GetHash() const noexcept
+    {
+        return m_Value->GetHash();
+    }
     void Json::Stringify(std::string &content) const noexcept
     {
-        m_Value->Stringify(content);
+        m_Value->Stringify(content, StringifyFlag::Default);
+    }
+    void Json::Stringify(std::string &content, int flags) const noexcept
+    {
+        m_Value->Stringify(content, flags);
+    }
+    void Json::ToCbor(std::string &content) const noexcept
+    {
+        m_Value->ToCbor(content);
+    }
+    void Json::ToMsgPack(std::string &content) const noexcept
+    {
+        m_Value->ToMsgPack(content);
+    }
+    void Json::ToSnapshot(std::string &content) const noexcept
+    {
+        m_Value->ToSnapshot(content);
+    }
+    JsonView Json::At(const JsonPointer &ptr) const
+    {
+        return JsonView(*this).At(ptr);
+    }
+    JsonView Json::Find(const JsonPointer &ptr) const noexcept
+    {
+        return JsonView(*this).Find(ptr);
+    }
+    std::vector<JsonView> Json::Query(const JsonPath &path) const
+    {
+        return JsonView(*this).Query(path);
+    }
+    std::vector<JsonColumn> Json::ExtractColumns(const std::vector<std::string> &fields) const
+    {
+        return JsonView(*this).ExtractColumns(fields);
+    }
+    JsonAggregate Json::Aggregate() const noexcept
+    {
+        return JsonView(*this).Aggregate();
+    }
+    std::vector<size_t> Json::Histogram(double lo, double hi, size_t bins) const
+    {
+        return JsonView(*this).Histogram(lo, hi, bins);
     }
-}
+}
\ No newline at end of file
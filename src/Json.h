@@ -1,7 +1,10 @@
 #ifndef JSON_H
 #define JSON_H
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace SJson
 {
@@ -15,10 +18,42 @@ namespace SJson
             Number,
             String,
             Array,
-            Object
+            Object,
+            /* 原样保存的 json 文本，序列化时直接输出；它是叶子，JsonPointer 与 JsonPath 不会进入其内部 */
+            Raw
+        };
+    }
+    namespace StringifyFlag
+    {
+        enum type : int
+        {
+            Default = 0,
+            /* 缓存数组和对象序列化后的结果，子树没有被修改时直接拼接缓存 */
+            Cache = 1 << 0,
+            /* 规范化输出（RFC 8785）：key 按 UTF-16 排序，数字取最短形式，最少转义，没有空白 */
+            Canonical = 1 << 1
+        };
+    }
+    namespace ParseFlag
+    {
+        enum type : int
+        {
+            Default = 0,
+            /* 字符串直接引用输入缓冲区中的字节而不拷贝，输入必须比解析结果活得更久并且不能被修改；解析 json 文本时带转义的字符串第一次读取时才解码 */
+            ZeroCopy = 1 << 0,
+            /* 解析 json 文本时检查字符串是否是合法的 UTF-8，不合法时为 "parse invalid utf8"；默认原样保留非 ASCII 字节 */
+            StrictUTF8 = 1 << 1,
+            /* 数字保存原文，GetNumber 时才转换，序列化时原样输出（规范化输出除外）；这样的数字不会保存为 packed 数组 */
+            LazyNumber = 1 << 2
         };
     }
     class JsonValue;
+    class JsonPointer;
+    class JsonPath;
+    class JsonView;
+    class JsonKeyTable;
+    struct JsonColumn;
+    struct JsonAggregate;
     class Json final
     {
     public:
@@ -32,8 +67,16 @@ namespace SJson
         void swap(Json &rhs) noexcept;
 
         /* 解析 json 字符串 */
-        void Parse(const std::string &content, std::string &status) noexcept;
-        void Parse(const std::string &content);
+        void Parse(const std::string &content, std::string &status, int flags = ParseFlag::Default) noexcept;
+        void Parse(const std::string &content, int flags = ParseFlag::Default);
+        /* 对象的 key 在文档内部总是只保存一份；传入同一张 key 表时，多次解析得到的文档也共享相同的 key */
+        void Parse(const std::string &content, std::string &status, JsonKeyTable &keys, int flags = ParseFlag::Default) noexcept;
+        void Parse(const std::string &content, JsonKeyTable &keys, int flags = ParseFlag::Default);
+        /* 只检查 size 个字节的 json 文本是否合法（RFC 8259 语法、转义与 UTF-8），不建立 JsonValue，不要求以 '\0' 结尾 */
+        static bool Validate(const char *data, size_t size) noexcept;
+        static bool Validate(const char *data, size_t size, std::string &status) noexcept;
+        /* 去掉 size 个字节的 json 文本中字符串之外的空白，不建立 JsonValue，数字和字符串原样保留；不检查语法，字符串没有结束时返回 false */
+        static bool Minify(const char *data, size_t size, std::string &content) noexcept;
 
         /* null true false */
         int GetType() const noexcept;
@@ -47,6 +90,8 @@ namespace SJson
         /* number */
         double GetNumber() const noexcept;
         void SetNumber(double d) noexcept;
+        /* 以 ParseFlag::LazyNumber 解析得到的数字的原文，其他数字为空 */
+        const std::string GetNumberText() const noexcept;
         Json &operator=(double d) noexcept
         {
             SetNumber(d);
@@ -56,21 +101,37 @@ namespace SJson
         /* string */
         const std::string GetString() const noexcept;
         void SetString(const std::string &str) noexcept;
+        void SetString(std::string &&str) noexcept;
         Json &operator=(const std::string &str) noexcept
         {
             SetString(str);
             return *this;
         }
+        Json &operator=(std::string &&str) noexcept
+        {
+            SetString(std::move(str));
+            return *this;
+        }
+
+        /* raw：content 必须是一个合法的 json 值（可以先用 Validate 检查），不解析，序列化时原样输出 */
+        const std::string GetRaw() const noexcept;
+        void SetRaw(const std::string &content) noexcept;
+        void SetRaw(std::string &&content) noexcept;
 
         /* array */
         size_t GetArraySize() const noexcept;
         Json GetArrayElement(size_t index) const noexcept;
         void SetArray() noexcept;
+        /* 接受右值的重载把 val 的内容移动到数组中，不做深拷贝，移动之后 val 变为 null */
         void PushbackArrayElement(const Json &val) noexcept;
+        void PushbackArrayElement(Json &&val) noexcept;
         void PopbackArrayElement() noexcept;
         void EraseArrayElement(size_t index, size_t count) noexcept;
         void InsertArrayElement(const Json &val, size_t index) noexcept;
+        void InsertArrayElement(Json &&val, size_t index) noexcept;
         void ClearArray() noexcept;
+        /* 预留数组的容量 */
+        void ReserveArray(size_t capacity) noexcept;
         /* object */
         void SetObject() noexcept;
         size_t GetObjectSize() const noexcept;
@@ -78,13 +139,50 @@ namespace SJson
         Json GetObjectValue(size_t index) const noexcept;
         size_t GetObjectKeyLength(size_t index) const noexcept;
         void SetObjectValue(const std::string &key, const Json &val) noexcept;
+        void SetObjectValue(const std::string &key, Json &&val) noexcept;
+        /* 把 key 和 val 移动到对象末尾，不查找 key 是否已经存在，调用者需要保证 key 不重复 */
+        void EmplaceObjectValue(std::string &&key, Json &&val) noexcept;
         long long FindObjectIndex(const std::string &key) const noexcept;
         void RemoveObjectValue(size_t index) noexcept;
         void ClearObject() noexcept;
+        /* 预留对象的容量 */
+        void ReserveObject(size_t capacity) noexcept;
+        /* JSON Patch（RFC 6902），原地修改文档；任何一个操作失败时已经应用的操作都会被撤销，然后抛出 JsonException */
+        void Patch(const Json &patch, std::string &status) noexcept;
+        void Patch(const Json &patch);
+        /* JSON Merge Patch（RFC 7386），原地修改文档 */
+        void MergePatch(const Json &patch) noexcept;
+        /* 生成把当前文档变为 target 的 JSON Patch，相同的子树通过结构哈希快速跳过 */
+        Json Diff(const Json &target) const noexcept;
+        /* 结构哈希：相等的 Json 哈希相同，对象的哈希与 key 的顺序无关，子树的哈希会被缓存 */
+        size_t GetHash() const noexcept;
         /* serialize */
         void Stringify(std::string &content) const noexcept;
+        void Stringify(std::string &content, int flags) const noexcept;
+        /* CBOR（RFC 8949）二进制格式的解码与编码 */
+        void ParseCbor(const std::string &content, std::string &status) noexcept;
+        void ParseCbor(const std::string &content);
+        void ToCbor(std::string &content) const noexcept;
+        /* MessagePack 二进制格式的解码与编码 */
+        void ParseMsgPack(const std::string &content, std::string &status, int flags = ParseFlag::Default) noexcept;
+        void ParseMsgPack(const std::string &content, int flags = ParseFlag::Default);
+        void ToMsgPack(std::string &content) const noexcept;
+        /* 生成可以用 mmap 直接查询的二进制快照，读取见 JsonSnapshot */
+        void ToSnapshot(std::string &content) const noexcept;
+        /* 按 JSON Pointer 查找，返回引用而不拷贝；At 找不到时抛出 JsonException，Find 找不到时返回无效的 JsonView */
+        JsonView At(const JsonPointer &ptr) const;
+        JsonView Find(const JsonPointer &ptr) const noexcept;
+        /* 执行编译好的 JSONPath 查询，按文档顺序返回匹配值的引用 */
+        std::vector<JsonView> Query(const JsonPath &path) const;
+        /* 把对象数组中的字段按列取出，一次遍历完成；key 序列相同的对象只查找一次字段的位置 */
+        std::vector<JsonColumn> ExtractColumns(const std::vector<std::string> &fields) const;
+        /* 数组中数字的 count、sum、min、max、mean，跳过非数字的元素；数字数组在连续的存储上用 SIMD 计算，元素很多时使用多个线程 */
+        JsonAggregate Aggregate() const noexcept;
+        /* 把 [lo, hi) 等分为 bins 段，统计每一段中数字的个数，范围之外的数字不计数；范围无效时抛出 JsonException */
+        std::vector<size_t> Histogram(double lo, double hi, size_t bins) const;
 
     private:
+        friend class JsonView;
         /* 使用桥接模式，Json暴露给用户，JsonValue来获取具体的值 */
         std::unique_ptr<JsonValue> m_Value;
         friend bool operator==(const Json &lhs, const Json &rhs) noexcept;
@@ -92,6 +190,53 @@ namespace SJson
     };
     bool operator==(const Json &lhs, const Json &rhs) noexcept;
     bool operator!=(const Json &lhs, const Json &rhs) noexcept;
+
+    /* 对 Json 中某个值的只读引用，不拷贝数据，在被引用的 Json 被修改或销毁之前有效 */
+    class JsonView final
+    {
+    public:
+        /* 无效的引用 */
+        JsonView() noexcept {}
+        JsonView(const Json &json) noexcept;
+        bool IsValid() const noexcept;
+
+        int GetType() const noexcept;
+        double GetNumber() const noexcept;
+        std::string_view GetNumberText() const noexcept;
+        std::string_view GetString() const noexcept;
+        std::string_view GetRaw() const noexcept;
+        size_t GetArraySize() const noexcept;
+        JsonView GetArrayElement(size_t index) const noexcept;
+        size_t GetObjectSize() const noexcept;
+        const std::string &GetObjectKey(size_t index) const noexcept;
+        JsonView GetObjectValue(size_t index) const noexcept;
+        long long FindObjectIndex(const std::string &key) const noexcept;
+        JsonView At(const JsonPointer &ptr) const;
+        JsonView Find(const JsonPointer &ptr) const noexcept;
+        std::vector<JsonView> Query(const JsonPath &path) const;
+        std::vector<JsonColumn> ExtractColumns(const std::vector<std::string> &fields) const;
+        JsonAggregate Aggregate() const noexcept;
+        std::vector<size_t> Histogram(double lo, double hi, size_t bins) const;
+        void Stringify(std::string &content, int flags = StringifyFlag::Default) const noexcept;
+        /* 拷贝为独立的 Json */
+        Json ToJson() const noexcept;
+
+    private:
+        explicit JsonView(const JsonValue *val) noexcept : m_Value(val) {}
+        const JsonValue *m_Value = nullptr;
+    };
     void swap(Json &lhs, Json &rhs) noexcept;
 }
+namespace std
+{
+    /* 使 Json 可以作为 unordered_map、unordered_set 的 key */
+    template <>
+    struct hash<SJson::Json>
+    {
+        size_t operator()(const SJson::Json &json) const noexcept
+        {
+            return json.GetHash();
+        }
+    };
+}
 #endif // JSON_H
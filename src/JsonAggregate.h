@@ -0,0 +1,17 @@
+#ifndef JSONAGGREGATE_H
+#define JSONAGGREGATE_H
+#include <cstddef>
+namespace SJson
+{
+    /* 数组中数字的统计结果，非数字的元素不参与统计 */
+    struct JsonAggregate
+    {
+        size_t count = 0;
+        double sum = 0;
+        /* count 为 0 时 min、max、mean 都是 0 */
+        double min = 0;
+        double max = 0;
+        double mean = 0;
+    };
+}
+#endif // JSONAGGREGATE_H
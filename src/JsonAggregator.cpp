@@ -0,0 +1,174 @@
+#include "JsonAggregator.h"
+#include "JsonException.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SJSON_SSE2
+#endif
+namespace SJson
+{
+    /* 元素个数达到这个值时才使用多个线程 */
+    static const size_t kParallelThreshold = 1 << 16;
+
+    /* 把 [0, n) 分为连续的若干段，每段交给一个线程执行 task(begin, end, part)，当前线程负责最后一段 */
+    template <typename Part, typename Task>
+    static std::vector<Part> RunParallel(size_t n, const Part &init, Task task)
+    {
+        size_t threads = std::thread::hardware_concurrency();
+        threads = std::max<size_t>(std::min(std::max<size_t>(threads, 1), n / (kParallelThreshold / 2)), 1);
+        std::vector<Part> parts(threads, init);
+        std::vector<std::thread> workers;
+        size_t chunk = (n + threads - 1) / threads;
+        for (size_t t = 0; t + 1 < threads; ++t)
+            workers.emplace_back([&task, &parts, t, chunk]()
+                                 { task(t * chunk, (t + 1) * chunk, parts[t]); });
+        task((threads - 1) * chunk, n, parts[threads - 1]);
+        for (auto &worker : workers)
+            worker.join();
+        return parts;
+    }
+
+    JsonAggregator::JsonAggregator(const JsonValue &arr, JsonAggregate &result)
+    {
+        assert(arr.GetType() == JsonType::Array);
+        result = JsonAggregate();
+        const size_t n = arr.GetArraySize();
+        if (const double *numbers = arr.GetArrayNumbers())
+        {
+            auto parts = RunParallel(n, JsonAggregate(), [numbers](size_t begin, size_t end, JsonAggregate &part)
+                                     { AggregateRange(numbers + begin, end - begin, part); });
+            for (const auto &part : parts)
+                Merge(result, part);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const JsonValue &element = arr.GetArrayElement(i);
+                if (element.GetType() == JsonType::Number)
+                    Merge(result, element.GetNumber());
+            }
+        }
+        if (result.count > 0)
+            result.mean = result.sum / static_cast<double>(result.count);
+    }
+
+    JsonAggregator::JsonAggregator(const JsonValue &arr, double lo, double hi, size_t bins, std::vector<size_t> &result)
+        : m_lo(lo), m_hi(hi), m_bins(bins)
+    {
+        assert(arr.GetType() == JsonType::Array);
+        if (bins == 0 || !(lo < hi) || !std::isfinite(hi - lo))
+            throw(JsonException("histogram invalid range"));
+        // hi - lo 是次正规数时 bins / (hi - lo) 会溢出为无穷大，之后的 (d - lo) * m_scale 可能得到 NaN
+        m_scale = static_cast<double>(bins) / (hi - lo);
+        if (!std::isfinite(m_scale))
+            throw(JsonException("histogram invalid range"));
+        result.assign(bins, 0);
+        const size_t n = arr.GetArraySize();
+        if (const double *numbers = arr.GetArrayNumbers())
+        {
+            auto parts = RunParallel(n, std::vector<size_t>(bins, 0), [this, numbers](size_t begin, size_t end, std::vector<size_t> &part)
+                                     { HistogramRange(numbers + begin, end - begin, part.data()); });
+            for (const auto &part : parts)
+            {
+                for (size_t b = 0; b < bins; ++b)
+                    result[b] += part[b];
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const JsonValue &element = arr.GetArrayElement(i);
+                if (element.GetType() == JsonType::Number)
+                    HistogramAdd(element.GetNumber(), result.data());
+            }
+        }
+    }
+
+    void JsonAggregator::AggregateRange(const double *data, size_t n, JsonAggregate &result) noexcept
+    {
+        if (n == 0)
+            return;
+        JsonAggregate part;
+        part.count = n;
+        size_t i = 0;
+        double sum = 0, min = data[0], max = data[0];
+#ifdef SJSON_SSE2
+        if (n >= 4)
+        {
+            // 两组累加器交替使用，减少加法之间的依赖
+            __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+            __m128d min0 = _mm_set1_pd(data[0]), min1 = min0, max0 = min0, max1 = min0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128d a = _mm_loadu_pd(data + i);
+                __m128d b = _mm_loadu_pd(data + i + 2);
+                sum0 = _mm_add_pd(sum0, a);
+                sum1 = _mm_add_pd(sum1, b);
+                min0 = _mm_min_pd(min0, a);
+                min1 = _mm_min_pd(min1, b);
+                max0 = _mm_max_pd(max0, a);
+                max1 = _mm_max_pd(max1, b);
+            }
+            double lanes[2];
+            _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+            sum = lanes[0] + lanes[1];
+            _mm_storeu_pd(lanes, _mm_min_pd(min0, min1));
+            min = std::min(lanes[0], lanes[1]);
+            _mm_storeu_pd(lanes, _mm_max_pd(max0, max1));
+            max = std::max(lanes[0], lanes[1]);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            sum += data[i];
+            min = std::min(min, data[i]);
+            max = std::max(max, data[i]);
+        }
+        part.sum = sum;
+        part.min = min;
+        part.max = max;
+        Merge(result, part);
+    }
+
+    void JsonAggregator::Merge(JsonAggregate &result, double d) noexcept
+    {
+        if (result.count == 0 || d < result.min)
+            result.min = d;
+        if (result.count == 0 || d > result.max)
+            result.max = d;
+        result.sum += d;
+        ++result.count;
+    }
+
+    void JsonAggregator::Merge(JsonAggregate &result, const JsonAggregate &part) noexcept
+    {
+        if (part.count == 0)
+            return;
+        if (result.count == 0 || part.min < result.min)
+            result.min = part.min;
+        if (result.count == 0 || part.max > result.max)
+            result.max = part.max;
+        result.sum += part.sum;
+        result.count += part.count;
+    }
+
+    void JsonAggregator::HistogramRange(const double *data, size_t n, size_t *counts) const noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+            HistogramAdd(data[i], counts);
+    }
+
+    void JsonAggregator::HistogramAdd(double d, size_t *counts) const noexcept
+    {
+        if (!(d >= m_lo && d < m_hi))
+            return;
+        // 舍入误差可能让接近 hi 的数字算到 bins，归入最后一段
+        size_t bin = static_cast<size_t>((d - m_lo) * m_scale);
+        ++counts[std::min(bin, m_bins - 1)];
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef JSONAGGREGATOR_H
+#define JSONAGGREGATOR_H
+#include "JsonValue.h"
+#include "JsonAggregate.h"
+namespace SJson
+{
+    /*
+     * 数组中数字的统计与直方图。紧凑保存的数字数组直接在连续的 double 上计算：
+     * 统计使用 SSE2 每次处理 4 个数字，元素很多时分段交给多个线程，最后合并各段的结果。
+     * 其他数组逐个元素计算，跳过非数字的元素。
+     */
+    class JsonAggregator
+    {
+    public:
+        JsonAggregator(const JsonValue &arr, JsonAggregate &result);
+        /* 把 [lo, hi) 等分为 bins 段，统计每一段中数字的个数；范围无效时抛出 JsonException */
+        JsonAggregator(const JsonValue &arr, double lo, double hi, size_t bins, std::vector<size_t> &result);
+
+    private:
+        /* 统计连续的 n 个数字，结果合并到 result 中 */
+        static void AggregateRange(const double *data, size_t n, JsonAggregate &result) noexcept;
+        static void Merge(JsonAggregate &result, double d) noexcept;
+        static void Merge(JsonAggregate &result, const JsonAggregate &part) noexcept;
+        /* 统计连续的 n 个数字，计数累加到 counts 中 */
+        void HistogramRange(const double *data, size_t n, size_t *counts) const noexcept;
+        void HistogramAdd(double d, size_t *counts) const noexcept;
+        double m_lo = 0;
+        double m_hi = 0;
+        double m_scale = 0;
+        size_t m_bins = 0;
+    };
+}
+#endif // JSONAGGREGATOR_H
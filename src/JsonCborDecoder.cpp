@@ -0,0 +1,236 @@
+#include "JsonCborDecoder.h"
+#include "JsonException.h"
+#include <cmath>
+#include <cstring>
+namespace SJson
+{
+    JsonCborDecoder::JsonCborDecoder(JsonValue &val, const std::string &content)
+        : m_cur(reinterpret_cast<const unsigned char *>(content.data())),
+          m_end(reinterpret_cast<const unsigned char *>(content.data()) + content.size())
+    {
+        val.SetType(JsonType::Null);
+        try
+        {
+            DecodeValue(val);
+            // 一个数据项解码完之后还有剩余的字节，说明数据不合法
+            if (m_cur != m_end)
+                throw(JsonException("cbor root not singular"));
+        }
+        catch (const JsonException &)
+        {
+            val.SetType(JsonType::Null);
+            throw;
+        }
+    }
+
+    void JsonCborDecoder::DecodeValue(JsonValue &val)
+    {
+        unsigned char initial = Next();
+        switch (initial >> 5)
+        {
+        // 主类型 0：无符号整数
+        case 0:
+            val.SetNumber(static_cast<double>(DecodeArgument(initial)));
+            break;
+        // 主类型 1：负整数，值为 -1 - n
+        case 1:
+            val.SetNumber(-1.0 - static_cast<double>(DecodeArgument(initial)));
+            break;
+        case 3:
+        {
+            std::string str;
+            DecodeString(initial, str);
+            val.SetString(std::move(str));
+        }
+        break;
+        case 4:
+            DecodeArray(initial, val);
+            break;
+        case 5:
+            DecodeObject(initial, val);
+            break;
+        // 主类型 6：标签，json 中没有对应的语义，忽略标签，直接解码被标记的数据项
+        case 6:
+            DecodeArgument(initial);
+            DecodeValue(val);
+            break;
+        case 7:
+            DecodeSimple(initial, val);
+            break;
+        // 主类型 2 是字节串，json 无法表示
+        default:
+            throw(JsonException("cbor unsupported type"));
+        }
+    }
+
+    void JsonCborDecoder::DecodeString(unsigned char initial, std::string &str)
+    {
+        if (initial >> 5 != 3)
+            throw(JsonException("cbor unsupported type"));
+        // 不定长字符串由若干个定长的文本字符串分块组成，以 0xFF 结束
+        if ((initial & 0x1F) == 31)
+        {
+            while (!AtBreak())
+            {
+                unsigned char chunk = Next();
+                if (chunk >> 5 != 3 || (chunk & 0x1F) == 31)
+                    throw(JsonException("cbor invalid string chunk"));
+                DecodeString(chunk, str);
+            }
+            return;
+        }
+        uint64_t len = DecodeArgument(initial);
+        if (len > static_cast<uint64_t>(m_end - m_cur))
+            throw(JsonException("cbor unexpected end"));
+        str.append(reinterpret_cast<const char *>(m_cur), static_cast<size_t>(len));
+        m_cur += len;
+    }
+
+    void JsonCborDecoder::DecodeArray(unsigned char initial, JsonValue &val)
+    {
+        std::vector<JsonValue> tmp;
+        if ((initial & 0x1F) == 31)
+        {
+            while (!AtBreak())
+            {
+                tmp.emplace_back();
+                DecodeValue(tmp.back());
+            }
+        }
+        else
+        {
+            // 每个元素至少占一个字节，元素个数超过剩余字节数时数据一定不完整
+            uint64_t size = DecodeArgument(initial);
+            if (size > static_cast<uint64_t>(m_end - m_cur))
+                throw(JsonException("cbor unexpected end"));
+            tmp.resize(static_cast<size_t>(size));
+            for (auto &element : tmp)
+                DecodeValue(element);
+        }
+        val.SetArray(std::move(tmp));
+    }
+
+    void JsonCborDecoder::DecodeObject(unsigned char initial, JsonValue &val)
+    {
+        std::vector<std::pair<JsonKey, JsonValue>> tmp;
+        bool indefinite = (initial & 0x1F) == 31;
+        uint64_t size = indefinite ? 0 : DecodeArgument(initial);
+        if (size > static_cast<uint64_t>(m_end - m_cur) / 2)
+            throw(JsonException("cbor unexpected end"));
+        tmp.reserve(static_cast<size_t>(size));
+        for (uint64_t i = 0; indefinite ? !AtBreak() : i < size; ++i)
+        {
+            // json 对象的 key 只能是文本字符串
+            unsigned char keyInitial = Next();
+            if (keyInitial >> 5 != 3)
+                throw(JsonException("cbor invalid key"));
+            std::string key;
+            DecodeString(keyInitial, key);
+            tmp.emplace_back(std::move(key), JsonValue());
+            DecodeValue(tmp.back().second);
+        }
+        val.SetObject(std::move(tmp));
+    }
+
+    void JsonCborDecoder::DecodeSimple(unsigned char initial, JsonValue &val)
+    {
+        double d;
+        switch (initial & 0x1F)
+        {
+        case 20:
+            val.SetType(JsonType::False);
+            return;
+        case 21:
+            val.SetType(JsonType::True);
+            return;
+        // undefined 在 json 中没有对应的值，按 null 处理
+        case 22:
+        case 23:
+            val.SetType(JsonType::Null);
+            return;
+        // 半精度浮点数
+        case 25:
+        {
+            unsigned half = static_cast<unsigned>(DecodeBigEndian(2));
+            int exp = (half >> 10) & 0x1F;
+            int mant = half & 0x3FF;
+            if (exp == 0)
+                d = std::ldexp(mant, -24);
+            else if (exp != 31)
+                d = std::ldexp(mant + 1024, exp - 25);
+            else
+                d = mant == 0 ? HUGE_VAL : std::nan("");
+            if (half & 0x8000)
+                d = -d;
+        }
+        break;
+        case 26:
+        {
+            uint32_t bits = static_cast<uint32_t>(DecodeBigEndian(4));
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            d = f;
+        }
+        break;
+        case 27:
+        {
+            uint64_t bits = DecodeBigEndian(8);
+            memcpy(&d, &bits, sizeof(d));
+        }
+        break;
+        default:
+            throw(JsonException("cbor unsupported type"));
+        }
+        // json 无法表示无穷大与 NaN
+        if (!std::isfinite(d))
+            throw(JsonException("cbor invalid number"));
+        val.SetNumber(d);
+    }
+
+    uint64_t JsonCborDecoder::DecodeArgument(unsigned char initial)
+    {
+        unsigned info = initial & 0x1F;
+        if (info < 24)
+            return info;
+        switch (info)
+        {
+        case 24:
+            return DecodeBigEndian(1);
+        case 25:
+            return DecodeBigEndian(2);
+        case 26:
+            return DecodeBigEndian(4);
+        case 27:
+            return DecodeBigEndian(8);
+        default:
+            throw(JsonException("cbor invalid additional info"));
+        }
+    }
+
+    uint64_t JsonCborDecoder::DecodeBigEndian(size_t bytes)
+    {
+        if (static_cast<size_t>(m_end - m_cur) < bytes)
+            throw(JsonException("cbor unexpected end"));
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+            value = (value << 8) | *m_cur++;
+        return value;
+    }
+
+    bool JsonCborDecoder::AtBreak()
+    {
+        if (m_cur == m_end)
+            throw(JsonException("cbor unexpected end"));
+        if (*m_cur != 0xFF)
+            return false;
+        ++m_cur;
+        return true;
+    }
+
+    unsigned char JsonCborDecoder::Next()
+    {
+        if (m_cur == m_end)
+            throw(JsonException("cbor unexpected end"));
+        return *m_cur++;
+    }
+}
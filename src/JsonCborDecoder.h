@@ -0,0 +1,32 @@
+#ifndef JSONCBORDECODER_H
+#define JSONCBORDECODER_H
+#include "JsonValue.h"
+#include <cstdint>
+namespace SJson
+{
+    /* 把 CBOR（RFC 8949）二进制数据解码为 JsonValue */
+    class JsonCborDecoder
+    {
+    public:
+        JsonCborDecoder(JsonValue &val, const std::string &content);
+
+    private:
+        /* 解码一个数据项 */
+        void DecodeValue(JsonValue &val);
+        /* 解码文本字符串，支持不定长字符串 */
+        void DecodeString(unsigned char initial, std::string &str);
+        void DecodeArray(unsigned char initial, JsonValue &val);
+        void DecodeObject(unsigned char initial, JsonValue &val);
+        /* 主类型 7：简单值与浮点数 */
+        void DecodeSimple(unsigned char initial, JsonValue &val);
+        /* 读取头部附加信息表示的整数或长度 */
+        uint64_t DecodeArgument(unsigned char initial);
+        uint64_t DecodeBigEndian(size_t bytes);
+        /* 下一个字节是否是不定长数据项的结束标记 0xFF */
+        bool AtBreak();
+        unsigned char Next();
+        const unsigned char *m_cur;
+        const unsigned char *m_end;
+    };
+}
+#endif // JSONCBORDECODER_H
@@ -0,0 +1,138 @@
+#include "JsonCborEncoder.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+namespace SJson
+{
+    JsonCborEncoder::JsonCborEncoder(const JsonValue &val, std::string &result) : m_res(result)
+    {
+        m_res.clear();
+        EncodeValue(val);
+    }
+
+    void JsonCborEncoder::EncodeValue(const JsonValue &val)
+    {
+        switch (val.GetType())
+        {
+        // null、true、false 是主类型 7 中的简单值
+        case JsonType::Null:
+            m_res += static_cast<char>(0xF6);
+            break;
+        case JsonType::True:
+            m_res += static_cast<char>(0xF5);
+            break;
+        case JsonType::False:
+            m_res += static_cast<char>(0xF4);
+            break;
+        case JsonType::Number:
+            EncodeNumber(val.GetNumber());
+            break;
+        case JsonType::String:
+            EncodeString(val.GetString());
+            break;
+        // 二进制格式没有 json 文本，编码解析后的值
+        case JsonType::Raw:
+            EncodeValue(val.ParseRaw());
+            break;
+        // 数组：主类型 4，头部记录元素个数
+        case JsonType::Array:
+            EncodeHead(4, val.GetArraySize());
+            if (const double *numbers = val.GetArrayNumbers())
+            {
+                for (size_t i = 0; i < val.GetArraySize(); ++i)
+                    EncodeNumber(numbers[i]);
+            }
+            else
+            {
+                for (size_t i = 0; i < val.GetArraySize(); ++i)
+                    EncodeValue(val.GetArrayElement(i));
+            }
+            break;
+        // 对象：主类型 5，头部记录键值对个数，key 编码为文本字符串
+        case JsonType::Object:
+            EncodeHead(5, val.GetObjectSize());
+            for (size_t i = 0; i < val.GetObjectSize(); ++i)
+            {
+                EncodeString(val.GetObjectKey(i));
+                EncodeValue(val.GetObjectValue(i));
+            }
+            break;
+        default:
+            assert(0 && "invalid type");
+        }
+    }
+
+    void JsonCborEncoder::EncodeNumber(double d)
+    {
+        // 整数优先编码为 CBOR 整数（主类型 0 和 1），-0 需要保留符号，只能编码为浮点数
+        if (d == std::floor(d) && !(d == 0 && std::signbit(d)))
+        {
+            if (d >= 0 && d < 18446744073709551616.0)
+            {
+                EncodeHead(0, static_cast<uint64_t>(d));
+                return;
+            }
+            if (d < 0 && d >= -9223372036854775808.0)
+            {
+                EncodeHead(1, static_cast<uint64_t>(-d) - 1);
+                return;
+            }
+        }
+        // 能用单精度无损表示的数字使用 4 字节浮点数，否则使用 8 字节双精度
+        float f = static_cast<float>(d);
+        if (static_cast<double>(f) == d)
+        {
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            m_res += static_cast<char>(0xFA);
+            EncodeBigEndian(bits, 4);
+        }
+        else
+        {
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            m_res += static_cast<char>(0xFB);
+            EncodeBigEndian(bits, 8);
+        }
+    }
+
+    void JsonCborEncoder::EncodeString(std::string_view str)
+    {
+        // 文本字符串：主类型 3，字符串本身就是 utf-8，不需要转义
+        EncodeHead(3, str.size());
+        m_res += str;
+    }
+
+    void JsonCborEncoder::EncodeHead(unsigned major, uint64_t value)
+    {
+        unsigned char type = static_cast<unsigned char>(major << 5);
+        if (value < 24)
+            m_res += static_cast<char>(type | value);
+        else if (value <= 0xFF)
+        {
+            m_res += static_cast<char>(type | 24);
+            EncodeBigEndian(value, 1);
+        }
+        else if (value <= 0xFFFF)
+        {
+            m_res += static_cast<char>(type | 25);
+            EncodeBigEndian(value, 2);
+        }
+        else if (value <= 0xFFFFFFFF)
+        {
+            m_res += static_cast<char>(type | 26);
+            EncodeBigEndian(value, 4);
+        }
+        else
+        {
+            m_res += static_cast<char>(type | 27);
+            EncodeBigEndian(value, 8);
+        }
+    }
+
+    void JsonCborEncoder::EncodeBigEndian(uint64_t value, size_t bytes)
+    {
+        for (size_t i = bytes; i > 0; --i)
+            m_res += static_cast<char>((value >> ((i - 1) * 8)) & 0xFF);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef JSONCBORENCODER_H
+#define JSONCBORENCODER_H
+#include "JsonValue.h"
+#include <cstdint>
+namespace SJson
+{
+    /* 把 JsonValue 编码为 CBOR（RFC 8949）二进制格式 */
+    class JsonCborEncoder
+    {
+    public:
+        JsonCborEncoder(const JsonValue &val, std::string &result);
+
+    private:
+        void EncodeValue(const JsonValue &val);
+        void EncodeNumber(double d);
+        void EncodeString(std::string_view str);
+        /* 写入数据项的头部：高 3 位是主类型，后面跟上长度或整数值 */
+        void EncodeHead(unsigned major, uint64_t value);
+        /* 以大端序写入 bytes 个字节 */
+        void EncodeBigEndian(uint64_t value, size_t bytes);
+        std::string &m_res;
+    };
+}
+#endif // JSONCBORENCODER_H
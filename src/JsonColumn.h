@@ -0,0 +1,36 @@
+#ifndef JSONCOLUMN_H
+#define JSONCOLUMN_H
+#include "Json.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace SJson
+{
+    /*
+     * 从对象数组中按列取出的一个字段，各个数组的第 i 个元素对应对象数组的第 i 行。
+     * 列的类型由第一个有值的行决定，类型不同的行与缺少字段、值为 null 的行一样记为无效。
+     */
+    struct JsonColumn
+    {
+        std::string name;
+        /* 第一个非 null 值的类型，true 和 false 都记为 JsonType::True；所有行都没有值时为 JsonType::Null */
+        int type = JsonType::Null;
+        /* 有效位图：第 i 位为 1 表示第 i 行的值有效 */
+        std::vector<uint64_t> validity;
+        /* 数字列的值，无效的行为 0 */
+        std::vector<double> numbers;
+        /* 数字列的有效值全部是 int64 范围内的整数时保存整数形式，否则为空 */
+        std::vector<int64_t> integers;
+        /* 字符串列的值，引用文档中的字符串，在文档被修改或销毁之前有效；无效的行为空 */
+        std::vector<std::string_view> strings;
+        /* 布尔列的值，无效的行为 0；数组、对象与 raw 列只记录有效位图 */
+        std::vector<uint8_t> booleans;
+
+        bool IsValid(size_t row) const noexcept
+        {
+            return ((validity[row / 64] >> (row % 64)) & 1) != 0;
+        }
+    };
+}
+#endif // JSONCOLUMN_H
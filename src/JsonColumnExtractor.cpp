@@ -0,0 +1,98 @@
+#include "JsonColumnExtractor.h"
+#include <cassert>
+#include <cmath>
+namespace SJson
+{
+    JsonColumnExtractor::JsonColumnExtractor(const JsonValue &rows, const std::vector<std::string> &fields, std::vector<JsonColumn> &columns)
+        : m_columns(columns), m_integral(fields.size(), true), m_rows(rows.GetArraySize())
+    {
+        assert(rows.GetType() == JsonType::Array);
+        m_columns.clear();
+        m_columns.resize(fields.size());
+        std::vector<size_t> hashes(fields.size());
+        for (size_t f = 0; f < fields.size(); ++f)
+        {
+            m_columns[f].name = fields[f];
+            m_columns[f].validity.assign((m_rows + 63) / 64, 0);
+            hashes[f] = JsonValue::HashKey(fields[f]);
+        }
+        // packed 数组的元素都是数字，没有对象，所有行都无效
+        if (rows.GetArrayNumbers() == nullptr)
+        {
+            // 记录上一个 shape 中每个字段的下标，shape 相同的行直接使用
+            const JsonShape *shape = nullptr;
+            std::vector<long long> slots(fields.size(), -1);
+            for (size_t row = 0; row < m_rows; ++row)
+            {
+                const JsonValue &obj = rows.GetArrayElement(row);
+                if (obj.GetType() != JsonType::Object)
+                    continue;
+                if (obj.GetObjectShape() != shape)
+                {
+                    shape = obj.GetObjectShape();
+                    for (size_t f = 0; f < fields.size(); ++f)
+                        slots[f] = obj.FindObjectIndex(fields[f], hashes[f]);
+                }
+                for (size_t f = 0; f < fields.size(); ++f)
+                {
+                    if (slots[f] >= 0)
+                        Append(f, row, obj.GetObjectValue(static_cast<size_t>(slots[f])));
+                }
+            }
+        }
+        for (size_t f = 0; f < fields.size(); ++f)
+        {
+            if (!m_integral[f])
+                std::vector<int64_t>().swap(m_columns[f].integers);
+        }
+    }
+
+    void JsonColumnExtractor::Append(size_t field, size_t row, const JsonValue &val)
+    {
+        JsonColumn &col = m_columns[field];
+        int type = val.GetType();
+        if (type == JsonType::Null)
+            return;
+        if (type == JsonType::False)
+            type = JsonType::True;
+        // 第一个有值的行决定列的类型，这时才分配对应的数组
+        if (col.type == JsonType::Null)
+        {
+            col.type = type;
+            if (type == JsonType::Number)
+            {
+                col.numbers.resize(m_rows);
+                col.integers.resize(m_rows);
+            }
+            else if (type == JsonType::String)
+                col.strings.resize(m_rows);
+            else if (type == JsonType::True)
+                col.booleans.resize(m_rows);
+        }
+        if (type != col.type)
+            return;
+        col.validity[row / 64] |= uint64_t(1) << (row % 64);
+        switch (type)
+        {
+        case JsonType::Number:
+        {
+            double d = val.GetNumber();
+            col.numbers[row] = d;
+            if (m_integral[field])
+            {
+                if (d == std::floor(d) && d >= -9223372036854775808.0 && d < 9223372036854775808.0)
+                    col.integers[row] = static_cast<int64_t>(d);
+                else
+                    m_integral[field] = false;
+            }
+        }
+        break;
+        case JsonType::String:
+            col.strings[row] = val.GetString();
+            break;
+        case JsonType::True:
+            col.booleans[row] = val.GetType() == JsonType::True;
+            break;
+        }
+    }
+}
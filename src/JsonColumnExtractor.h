@@ -0,0 +1,25 @@
+#ifndef JSONCOLUMNEXTRACTOR_H
+#define JSONCOLUMNEXTRACTOR_H
+#include "JsonValue.h"
+#include "JsonColumn.h"
+namespace SJson
+{
+    /*
+     * 一次遍历对象数组，把指定的字段取出为连续的列。
+     * 字段在对象中的下标按 shape 缓存，连续的行 shape 相同时不再查找 key。
+     */
+    class JsonColumnExtractor
+    {
+    public:
+        JsonColumnExtractor(const JsonValue &rows, const std::vector<std::string> &fields, std::vector<JsonColumn> &columns);
+
+    private:
+        /* 把第 row 行的值写入第 field 列 */
+        void Append(size_t field, size_t row, const JsonValue &val);
+        std::vector<JsonColumn> &m_columns;
+        /* 每一列的有效值是否都是整数 */
+        std::vector<bool> m_integral;
+        size_t m_rows;
+    };
+}
+#endif // JSONCOLUMNEXTRACTOR_H
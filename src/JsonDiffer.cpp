@@ -0,0 +1,193 @@
+#include "JsonDiffer.h"
+#include <algorithm>
+namespace SJson
+{
+    /* 数组中间部分的长度乘积不超过这个值时才求最长公共子序列，否则按位置逐个比较 */
+    static const size_t kLcsMaxCells = 1 << 20;
+
+    JsonDiffer::JsonDiffer(const JsonValue &source, const JsonValue &target, JsonValue &patch)
+    {
+        DiffValue(source, target);
+        patch.SetArray(std::vector<JsonValue>{});
+        for (auto &op : m_ops)
+            patch.PushbackArrayElement(std::move(op));
+    }
+
+    void JsonDiffer::DiffValue(const JsonValue &source, const JsonValue &target)
+    {
+        // 哈希不同一定不相等；哈希相同时还需要确认，避免冲突导致漏掉修改
+        if (source.GetHash() == target.GetHash() && source == target)
+            return;
+        if (source.GetType() == JsonType::Object && target.GetType() == JsonType::Object)
+            DiffObject(source, target);
+        else if (source.GetType() == JsonType::Array && target.GetType() == JsonType::Array)
+            DiffArray(source, target);
+        else
+            Emit("replace", &target);
+    }
+
+    void JsonDiffer::DiffObject(const JsonValue &source, const JsonValue &target)
+    {
+        for (size_t i = 0, n = source.GetObjectSize(); i < n; ++i)
+        {
+            const std::string &key = source.GetObjectKey(i);
+            long long index = target.FindObjectIndex(key);
+            size_t len = PushPath(key);
+            if (index < 0)
+                Emit("remove", nullptr);
+            else
+                DiffValue(source.GetObjectValue(i), target.GetObjectValue(static_cast<size_t>(index)));
+            m_path.resize(len);
+        }
+        for (size_t i = 0, n = target.GetObjectSize(); i < n; ++i)
+        {
+            const std::string &key = target.GetObjectKey(i);
+            if (source.FindObjectIndex(key) >= 0)
+                continue;
+            size_t len = PushPath(key);
+            Emit("add", &target.GetObjectValue(i));
+            m_path.resize(len);
+        }
+    }
+
+    void JsonDiffer::DiffArray(const JsonValue &source, const JsonValue &target)
+    {
+        const size_t n = source.GetArraySize(), m = target.GetArraySize();
+        auto same = [&](size_t i, size_t j) {
+            const JsonValue &a = source.GetArrayElement(i), &b = target.GetArrayElement(j);
+            return a.GetHash() == b.GetHash() && a == b;
+        };
+        // 去掉相同的前缀和后缀
+        size_t prefix = 0;
+        while (prefix < n && prefix < m && same(prefix, prefix))
+            ++prefix;
+        size_t suffix = 0;
+        while (suffix < n - prefix && suffix < m - prefix && same(n - 1 - suffix, m - 1 - suffix))
+            ++suffix;
+        const size_t rows = n - prefix - suffix, cols = m - prefix - suffix;
+
+        // 编辑脚本：'=' 保留（可能还需要递归比较），'-' 删除 source 的元素，'+' 插入 target 的元素
+        std::string script;
+        if (rows * cols <= kLcsMaxCells)
+        {
+            std::vector<size_t> hashA(rows), hashB(cols);
+            for (size_t i = 0; i < rows; ++i)
+                hashA[i] = source.GetArrayElement(prefix + i).GetHash();
+            for (size_t j = 0; j < cols; ++j)
+                hashB[j] = target.GetArrayElement(prefix + j).GetHash();
+            // lcs[i][j] 是 source[i..] 与 target[j..] 的最长公共子序列长度
+            std::vector<uint32_t> lcs((rows + 1) * (cols + 1), 0);
+            auto at = [cols](size_t i, size_t j) { return i * (cols + 1) + j; };
+            for (size_t i = rows; i-- > 0;)
+            {
+                for (size_t j = cols; j-- > 0;)
+                {
+                    if (hashA[i] == hashB[j])
+                        lcs[at(i, j)] = lcs[at(i + 1, j + 1)] + 1;
+                    else
+                        lcs[at(i, j)] = std::max(lcs[at(i + 1, j)], lcs[at(i, j + 1)]);
+                }
+            }
+            size_t i = 0, j = 0;
+            while (i < rows || j < cols)
+            {
+                if (i < rows && j < cols && hashA[i] == hashB[j])
+                {
+                    script += '=';
+                    ++i, ++j;
+                }
+                else if (j == cols || (i < rows && lcs[at(i + 1, j)] >= lcs[at(i, j + 1)]))
+                {
+                    script += '-';
+                    ++i;
+                }
+                else
+                {
+                    script += '+';
+                    ++j;
+                }
+            }
+        }
+        else
+        {
+            // 太大时按位置对齐，多出来的部分删除或插入
+            script.assign(std::min(rows, cols), '=');
+            script.append(rows > cols ? rows - cols : 0, '-');
+            script.append(cols > rows ? cols - rows : 0, '+');
+        }
+
+        // 按脚本生成操作，pos 是元素在已经应用了前面操作的数组中的下标
+        size_t i = prefix, j = prefix, pos = prefix;
+        for (size_t k = 0; k < script.size();)
+        {
+            if (script[k] == '=')
+            {
+                size_t len = PushPath(pos);
+                DiffValue(source.GetArrayElement(i), target.GetArrayElement(j));
+                m_path.resize(len);
+                ++i, ++j, ++pos, ++k;
+                continue;
+            }
+            // 一段连续的删除和插入：配对的部分转换为递归比较，剩下的删除或插入
+            size_t dels = 0, adds = 0;
+            for (; k < script.size() && script[k] != '='; ++k)
+                script[k] == '-' ? ++dels : ++adds;
+            for (size_t p = 0, pairs = std::min(dels, adds); p < pairs; ++p)
+            {
+                size_t len = PushPath(pos);
+                DiffValue(source.GetArrayElement(i), target.GetArrayElement(j));
+                m_path.resize(len);
+                ++i, ++j, ++pos;
+            }
+            for (; dels > adds; --dels, ++i)
+            {
+                size_t len = PushPath(pos);
+                Emit("remove", nullptr);
+                m_path.resize(len);
+            }
+            for (; adds > dels; --adds, ++j, ++pos)
+            {
+                size_t len = PushPath(pos);
+                Emit("add", &target.GetArrayElement(j));
+                m_path.resize(len);
+            }
+        }
+    }
+
+    size_t JsonDiffer::PushPath(const std::string &token)
+    {
+        size_t len = m_path.size();
+        m_path += '/';
+        for (char ch : token)
+        {
+            if (ch == '~')
+                m_path += "~0";
+            else if (ch == '/')
+                m_path += "~1";
+            else
+                m_path += ch;
+        }
+        return len;
+    }
+
+    size_t JsonDiffer::PushPath(size_t index)
+    {
+        size_t len = m_path.size();
+        m_path += '/';
+        m_path += std::to_string(index);
+        return len;
+    }
+
+    void JsonDiffer::Emit(const char *op, const JsonValue *value)
+    {
+        m_ops.emplace_back();
+        JsonValue &obj = m_ops.back(), str;
+        obj.SetObject(std::vector<std::pair<JsonKey, JsonValue>>{});
+        str.SetString(op);
+        obj.InsertObjectValue(0, "op", std::move(str));
+        str.SetString(m_path);
+        obj.InsertObjectValue(1, "path", std::move(str));
+        if (value != nullptr)
+            obj.InsertObjectValue(2, "value", JsonValue(*value));
+    }
+}
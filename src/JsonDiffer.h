@@ -0,0 +1,28 @@
+#ifndef JSONDIFFER_H
+#define JSONDIFFER_H
+#include "JsonValue.h"
+namespace SJson
+{
+    /*
+     * 生成把 source 变为 target 的 JSON Patch（RFC 6902）。
+     * 结构哈希相同的子树直接跳过；对象按 key 的哈希表匹配成员；
+     * 数组先去掉相同的前缀和后缀，中间部分按元素哈希求最长公共子序列，删除与插入相邻时合并为对元素的递归比较。
+     */
+    class JsonDiffer
+    {
+    public:
+        JsonDiffer(const JsonValue &source, const JsonValue &target, JsonValue &patch);
+
+    private:
+        void DiffValue(const JsonValue &source, const JsonValue &target);
+        void DiffObject(const JsonValue &source, const JsonValue &target);
+        void DiffArray(const JsonValue &source, const JsonValue &target);
+        /* 在当前路径后面追加一个 token，返回原来的长度，用于恢复 */
+        size_t PushPath(const std::string &token);
+        size_t PushPath(size_t index);
+        void Emit(const char *op, const JsonValue *value);
+        std::vector<JsonValue> m_ops;
+        std::string m_path;
+    };
+}
+#endif // JSONDIFFER_H
@@ -1,13 +1,86 @@
 #include "JsonGenerator.h"
+#include "JsonUtf8.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
 namespace SJson
 {
-    JsonGenerator::JsonGenerator(const JsonValue &val, std::string &result) : m_res(result)
+    /* 子元素个数达到该阈值时才启用多线程生成，避免小数组付出创建线程的开销 */
+    static const size_t kParallelThreshold = 8192;
+
+    /* 序列化结果短于该长度的数组和对象不写缓存，拼接缓存并不比重新生成更快 */
+    static const size_t kCacheMinLength = 64;
+
+    /* 按 UTF-16 编码单元逐个取出 utf-8 字符串中的字符，规范化输出要求按 UTF-16 的顺序对 key 排序 */
+    class Utf16Reader
+    {
+    public:
+        explicit Utf16Reader(const std::string &str) noexcept : m_cur(str.data()), m_end(str.data() + str.size()) {}
+        bool Next(unsigned &unit) noexcept
+        {
+            if (m_low != 0)
+            {
+                unit = m_low;
+                m_low = 0;
+                return true;
+            }
+            if (m_cur == m_end)
+                return false;
+            unsigned char ch = *m_cur++;
+            unsigned u = ch;
+            int follow = 0;
+            if (ch >= 0xF0)
+                u = ch & 0x07, follow = 3;
+            else if (ch >= 0xE0)
+                u = ch & 0x0F, follow = 2;
+            else if (ch >= 0xC0)
+                u = ch & 0x1F, follow = 1;
+            for (; follow > 0 && m_cur != m_end; --follow)
+                u = (u << 6) | (static_cast<unsigned char>(*m_cur++) & 0x3F);
+            if (u >= 0x10000)
+            {
+                // 超出基本平面的字符拆成高、低两个代理项
+                u -= 0x10000;
+                m_low = 0xDC00 | (u & 0x3FF);
+                u = 0xD800 | (u >> 10);
+            }
+            unit = u;
+            return true;
+        }
+
+    private:
+        const char *m_cur;
+        const char *m_end;
+        unsigned m_low = 0;
+    };
+
+    static bool Utf16Less(const std::string &lhs, const std::string &rhs) noexcept
+    {
+        Utf16Reader l(lhs), r(rhs);
+        unsigned a = 0, b = 0;
+        for (;;)
+        {
+            bool hasLeft = l.Next(a), hasRight = r.Next(b);
+            if (!hasLeft || !hasRight)
+                return !hasLeft && hasRight;
+            if (a != b)
+                return a < b;
+        }
+    }
+
+    JsonGenerator::JsonGenerator(const JsonValue &val, std::string &result, int flags)
+        : m_res(result), m_flags(flags), m_parallel(true)
     {
         m_res.clear();
         StringifyValue(val);
     }
 
+    JsonGenerator::JsonGenerator(std::string &result, int flags) noexcept
+        : m_res(result), m_flags(flags), m_parallel(false) {}
+
     /* 生成json的值 */
     void JsonGenerator::StringifyValue(const JsonValue &val)
     {
@@ -24,50 +97,193 @@ namespace SJson
             break;
         case JsonType::Number:
         {
-            char buffer[32] = {0};
-            sprintf(buffer, "%.17g", val.GetNumber());
-            m_res += buffer;
+            // 保存了原文的数字原样输出，不需要转换；规范化输出要求最短形式，仍然重新生成
+            std::string_view text = val.GetNumberText();
+            if (!text.empty() && !(m_flags & StringifyFlag::Canonical))
+                m_res += text;
+            else
+                StringifyNumber(val.GetNumber());
         }
         break;
         case JsonType::String:
-            StringifyString(val.GetString()); // 生成字符串
+        {
+            // 还没有解码的字符串原文已经是合法的 json 字符串，直接输出；规范化输出要求最少转义，仍然重新生成
+            std::string_view escaped = val.GetEscapedString();
+            if (!escaped.empty() && !(m_flags & StringifyFlag::Canonical))
+                m_res += escaped;
+            else
+                StringifyString(val.GetString()); // 生成字符串
+        }
+        break;
+        // raw 文本原样输出；规范化输出要求统一的格式，只能解析之后重新生成
+        case JsonType::Raw:
+            if (m_flags & StringifyFlag::Canonical)
+                StringifyValue(val.ParseRaw());
+            else
+                m_res += val.GetRaw();
             break;
-        // 生成数组：只要输出"[]"，中间对逐个子值递归调用 stringify_value()
+        // 生成数组和对象
         case JsonType::Array:
-            m_res += '[';
-            for (size_t i = 0; i < val.GetArraySize(); i++)
+        case JsonType::Object:
+            StringifyContainer(val);
+            break;
+        default:
+            assert(0 && "invalid type");
+        }
+    }
+    void JsonGenerator::StringifyNumber(double d)
+    {
+        // json 没有无穷大和 NaN，Stringify 不能报错，与 JSON.stringify 一样输出 null
+        if (!std::isfinite(d))
+        {
+            m_res += "null";
+            return;
+        }
+        if (m_flags & StringifyFlag::Canonical)
+        {
+            StringifyCanonicalNumber(d);
+            return;
+        }
+        char buffer[32] = {0};
+        sprintf(buffer, "%.17g", d);
+        m_res += buffer;
+    }
+    void JsonGenerator::StringifyContainer(const JsonValue &val)
+    {
+        // 子树没有被修改过，直接拼接上一次的序列化结果；规范化输出的格式不同，不使用缓存
+        const bool useCache = (m_flags & StringifyFlag::Cache) && !(m_flags & StringifyFlag::Canonical);
+        if (useCache)
+        {
+            if (auto cache = val.GetStringifyCache())
             {
-                if (i > 0)
-                    m_res += ',';
-                StringifyValue(val.GetArrayElement(i));
+                m_res += *cache;
+                return;
             }
+        }
+        const size_t start = m_res.size();
+        switch (val.GetType())
+        {
+        // 生成数组：只要输出"[]"，中间对逐个子值递归调用 stringify_value()
+        case JsonType::Array:
+            m_res += '[';
+            if (m_parallel && val.GetArraySize() >= kParallelThreshold)
+                StringifyParallel(val, val.GetArraySize(), nullptr);
+            else
+                StringifyRange(val, 0, val.GetArraySize(), nullptr);
             m_res += ']';
             break;
         // 生成对象
         case JsonType::Object:
+        {
+            // 规范化输出时按 key 排序后的顺序生成各个键值对
+            std::vector<size_t> order;
+            if (m_flags & StringifyFlag::Canonical)
+            {
+                order.resize(val.GetObjectSize());
+                for (size_t i = 0; i < order.size(); ++i)
+                    order[i] = i;
+                std::sort(order.begin(), order.end(), [&val](size_t a, size_t b)
+                          { return Utf16Less(val.GetObjectKey(a), val.GetObjectKey(b)); });
+            }
+            const size_t *sorted = order.empty() ? nullptr : order.data();
             m_res += '{';
-            for (int i = 0; i < val.GetObjectSize(); ++i)
+            if (m_parallel && val.GetObjectSize() >= kParallelThreshold)
+                StringifyParallel(val, val.GetObjectSize(), sorted);
+            else
+                StringifyRange(val, 0, val.GetObjectSize(), sorted);
+            m_res += '}';
+        }
+        break;
+        }
+        if (useCache && m_res.size() - start >= kCacheMinLength)
+            val.SetStringifyCache(m_res.substr(start));
+    }
+    void JsonGenerator::StringifyRange(const JsonValue &val, size_t begin, size_t end, const size_t *order)
+    {
+        if (val.GetType() == JsonType::Array)
+        {
+            // packed 数组直接生成数字
+            if (const double *numbers = val.GetArrayNumbers())
             {
-                if (i > 0)
+                for (size_t i = begin; i < end; i++)
+                {
+                    if (i > begin)
+                        m_res += ',';
+                    StringifyNumber(numbers[i]);
+                }
+                return;
+            }
+            for (size_t i = begin; i < end; i++)
+            {
+                if (i > begin)
                     m_res += ',';
-                // 对象需要多处理一个 key 和冒号
-                StringifyString(val.GetObjectKey(i));
-                m_res += ':';
-                // 递归调用生成 json 值
-                StringifyValue(val.GetObjectValue(i));
+                StringifyValue(val.GetArrayElement(i));
             }
-            m_res += '}';
-            break;
-        default:
-            assert(0 && "invalid type");
+            return;
+        }
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (i > begin)
+                m_res += ',';
+            size_t index = order ? order[i] : i;
+            // 对象需要多处理一个 key 和冒号
+            StringifyString(val.GetObjectKey(index));
+            m_res += ':';
+            // 递归调用生成 json 值
+            StringifyValue(val.GetObjectValue(index));
+        }
+    }
+    void JsonGenerator::StringifyParallel(const JsonValue &val, size_t size, const size_t *order)
+    {
+        size_t threads = std::thread::hardware_concurrency();
+        threads = std::min(std::max<size_t>(threads, 1), size / (kParallelThreshold / 2));
+        if (threads <= 1)
+        {
+            StringifyRange(val, 0, size, order);
+            return;
+        }
+        // 每个线程生成一段连续的子元素到各自的缓冲区，当前线程负责最后一段
+        std::vector<std::string> buffers(threads);
+        std::vector<std::thread> workers;
+        size_t chunk = (size + threads - 1) / threads;
+        for (size_t t = 0; t + 1 < threads; ++t)
+        {
+            workers.emplace_back([&val, &buffers, t, chunk, order, flags = m_flags]()
+                                 { JsonGenerator(buffers[t], flags).StringifyRange(val, t * chunk, (t + 1) * chunk, order); });
+        }
+        JsonGenerator(buffers[threads - 1], m_flags).StringifyRange(val, (threads - 1) * chunk, size, order);
+        for (auto &worker : workers)
+            worker.join();
+
+        // 按顺序拼接各段的结果，段与段之间补上逗号
+        size_t total = m_res.size() + threads;
+        for (const auto &buffer : buffers)
+            total += buffer.size();
+        m_res.reserve(total);
+        bool first = true;
+        for (const auto &buffer : buffers)
+        {
+            if (buffer.empty())
+                continue;
+            if (!first)
+                m_res += ',';
+            m_res += buffer;
+            first = false;
         }
     }
-    void JsonGenerator::StringifyString(const std::string &str)
+    void JsonGenerator::StringifyString(std::string_view str)
     {
         m_res += '\"';
-        for (auto it = str.begin(); it != str.end(); it++)
+        const char *p = str.data(), *end = str.data() + str.size();
+        while (p != end)
         {
-            unsigned char ch = *it;
+            // 不需要转义的连续字节一次性追加
+            size_t run = ScanStringRun(p, end, '\"');
+            m_res.append(p, run);
+            p += run;
+            if (p == end)
+                break;
+            unsigned char ch = *p++;
             switch (ch)
             {
             /* 添加这些转义字符 */
@@ -96,14 +312,81 @@ namespace SJson
                 // 低于 0x20 的字符需要转义为 \u00xx 的形式
                 if (ch < 0x20)
                 {
+                    // 规范化输出要求十六进制数字使用小写
                     char buffer[7] = {0};
-                    sprintf(buffer, "\\u%04X", ch);
+                    sprintf(buffer, (m_flags & StringifyFlag::Canonical) ? "\\u%04x" : "\\u%04X", ch);
                     m_res += buffer;
                 }
                 else
-                    m_res += *it;
+                    m_res += static_cast<char>(ch);
             }
         }
         m_res += '\"'; // 添加最后一个双引号
     }
+    void JsonGenerator::StringifyCanonicalNumber(double d)
+    {
+        // 0 和 -0 都输出为 0
+        if (d == 0)
+        {
+            m_res += '0';
+            return;
+        }
+        // 找到能够还原出同一个 double 的最短有效数字
+        char buffer[32] = {0};
+        for (int precision = 1; precision <= 17; ++precision)
+        {
+            snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, d);
+            if (strtod(buffer, NULL) == d)
+                break;
+        }
+
+        // 拆出有效数字 digits 与十进制指数，值为 0.digits * 10^n
+        const char *p = buffer;
+        if (*p == '-')
+        {
+            m_res += '-';
+            ++p;
+        }
+        std::string digits;
+        for (; *p != 'e'; ++p)
+        {
+            if (*p != '.')
+                digits += *p;
+        }
+        while (digits.size() > 1 && digits.back() == '0')
+            digits.pop_back();
+        int k = static_cast<int>(digits.size());
+        int n = atoi(p + 1) + 1;
+
+        // 按照 ECMAScript 的 Number.prototype.toString 规则输出
+        if (k <= n && n <= 21)
+        {
+            m_res += digits;
+            m_res.append(n - k, '0');
+        }
+        else if (0 < n && n <= 21)
+        {
+            m_res.append(digits, 0, n);
+            m_res += '.';
+            m_res.append(digits, n, std::string::npos);
+        }
+        else if (-6 < n && n <= 0)
+        {
+            m_res += "0.";
+            m_res.append(-n, '0');
+            m_res += digits;
+        }
+        else
+        {
+            m_res += digits[0];
+            if (k > 1)
+            {
+                m_res += '.';
+                m_res.append(digits, 1, std::string::npos);
+            }
+            m_res += 'e';
+            m_res += n - 1 >= 0 ? '+' : '-';
+            m_res += std::to_string(n - 1 >= 0 ? n - 1 : 1 - n);
+        }
+    }
 }
\ No newline at end of file
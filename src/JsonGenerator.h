@@ -6,12 +6,25 @@ namespace SJson
     class JsonGenerator
     {
     public:
-        JsonGenerator(const JsonValue &val, std::string &result);
+        JsonGenerator(const JsonValue &val, std::string &result, int flags = StringifyFlag::Default);
 
     private:
+        /* 工作线程使用的生成器：只向 result 追加内容，并且不再继续拆分任务 */
+        JsonGenerator(std::string &result, int flags) noexcept;
         void StringifyValue(const JsonValue &val);
-        void StringifyString(const std::string &str);
+        /* 生成数组或对象，开启缓存时优先使用子树的序列化缓存 */
+        void StringifyContainer(const JsonValue &val);
+        void StringifyNumber(double d);
+        void StringifyString(std::string_view str);
+        /* 以最短且能还原的形式生成数字（RFC 8785） */
+        void StringifyCanonicalNumber(double d);
+        /* 生成数组或对象中第 [begin, end) 个子元素，元素之间用逗号分隔；order 不为空时按 order[i] 取对象的键值对 */
+        void StringifyRange(const JsonValue &val, size_t begin, size_t end, const size_t *order);
+        /* 子元素很多时，把子元素分段交给多个线程生成，再按顺序拼接 */
+        void StringifyParallel(const JsonValue &val, size_t size, const size_t *order);
         std::string &m_res;
+        int m_flags;
+        bool m_parallel;
     };
 }
-#endif // JSONGENERATOR_H
\ No newline at end of file
+#endif // JSONGENERATOR_H
@@ -0,0 +1,45 @@
+#include "JsonKeyTable.h"
+namespace SJson
+{
+    static size_t HashString(std::string_view key) noexcept
+    {
+        return std::hash<std::string_view>()(key);
+    }
+
+    JsonKey::JsonKey() noexcept
+    {
+        // 所有空 key 共享同一份字符串
+        static const std::shared_ptr<const Entry> empty = std::make_shared<const Entry>(Entry{std::string(), HashString("")});
+        m_entry = empty;
+    }
+
+    JsonKey::JsonKey(const std::string &key) : m_entry(std::make_shared<const Entry>(Entry{key, HashString(key)}))
+    {
+    }
+
+    JsonKey::JsonKey(std::string &&key)
+    {
+        size_t hash = HashString(key);
+        m_entry = std::make_shared<const Entry>(Entry{std::move(key), hash});
+    }
+
+    const JsonKey &JsonKeyTable::Intern(std::string_view key)
+    {
+        auto it = m_keys.find(key);
+        if (it != m_keys.end())
+            return it->second;
+        JsonKey interned{std::string(key)};
+        std::string_view view = interned.GetString();
+        return m_keys.emplace(view, std::move(interned)).first->second;
+    }
+
+    size_t JsonKeyTable::GetSize() const noexcept
+    {
+        return m_keys.size();
+    }
+
+    void JsonKeyTable::Clear() noexcept
+    {
+        m_keys.clear();
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef JSONKEYTABLE_H
+#define JSONKEYTABLE_H
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+namespace SJson
+{
+    /*
+     * 对象的 key：引用一份不可修改的字符串和它的哈希值，拷贝只增加引用计数。
+     * 由同一张 JsonKeyTable 得到的相同 key 指向同一份字符串，比较时先比较指针。
+     */
+    class JsonKey final
+    {
+    public:
+        /* 空字符串 */
+        JsonKey() noexcept;
+        JsonKey(const std::string &key);
+        JsonKey(std::string &&key);
+
+        const std::string &GetString() const noexcept { return m_entry->str; }
+        /* 与 JsonValue::HashKey 的结果相同 */
+        size_t GetHash() const noexcept { return m_entry->hash; }
+        bool Equals(std::string_view key) const noexcept
+        {
+            const std::string &str = m_entry->str;
+            return (str.data() == key.data() && str.size() == key.size()) || str == key;
+        }
+        friend bool operator==(const JsonKey &lhs, const JsonKey &rhs) noexcept
+        {
+            return lhs.m_entry == rhs.m_entry || lhs.m_entry->str == rhs.m_entry->str;
+        }
+        friend bool operator!=(const JsonKey &lhs, const JsonKey &rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class JsonKeyTable;
+        struct Entry
+        {
+            std::string str;
+            size_t hash;
+        };
+        explicit JsonKey(std::shared_ptr<const Entry> &&entry) noexcept : m_entry(std::move(entry)) {}
+        std::shared_ptr<const Entry> m_entry;
+    };
+
+    /*
+     * key 的 intern 表：解析时相同的 key 只保存一份字符串。Json::Parse 默认在每个文档内部使用一张临时的表，
+     * 也可以把同一张表传给多次解析，让多个文档共享 key。表本身不是线程安全的，并发解析时每个线程使用各自的表。
+     */
+    class JsonKeyTable final
+    {
+    public:
+        /* 返回与 key 内容相同的唯一 JsonKey，第一次出现时保存一份；引用在 Clear 或表被销毁之前有效 */
+        const JsonKey &Intern(std::string_view key);
+        /* 不同 key 的个数 */
+        size_t GetSize() const noexcept;
+        /* 清空表，已经解析出来的文档仍然持有各自的 key */
+        void Clear() noexcept;
+
+    private:
+        /* map 的 key 引用 JsonKey 中保存的字符串，JsonKey 存在时字符串的地址不变 */
+        std::unordered_map<std::string_view, JsonKey> m_keys;
+    };
+}
+#endif // JSONKEYTABLE_H
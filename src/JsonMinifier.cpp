@@ -0,0 +1,83 @@
+#include "JsonMinifier.h"
+#include "JsonException.h"
+#include "JsonUtf8.h"
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SJSON_SSE2
+#endif
+namespace SJson
+{
+    static bool IsWhitespace(char ch) noexcept
+    {
+        return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+    }
+
+    JsonMinifier::JsonMinifier(const char *data, size_t size, std::string &content)
+        : m_cur(data), m_end(data + size)
+    {
+        content.resize(size);
+        char *begin = &content[0];
+        m_out = begin;
+        while (m_cur < m_end)
+        {
+#ifdef SJSON_SSE2
+            if (m_end - m_cur >= 16)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(m_cur));
+                const __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+                                                _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+                const int wsMask = _mm_movemask_epi8(ws);
+                const int quoteMask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"')));
+                if ((wsMask | quoteMask) == 0)
+                {
+                    // 没有空白也没有字符串，整块写出；结果的位置不会超过输入的位置，写 16 个字节不会越界
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(m_out), chunk);
+                    m_out += 16;
+                    m_cur += 16;
+                    continue;
+                }
+                // 只处理第一个引号之前的字节：每个字节都写出，但只有不是空白时才前进
+                int stop = 0;
+                while (stop < 16 && !(quoteMask & (1 << stop)))
+                {
+                    *m_out = m_cur[stop];
+                    m_out += !(wsMask & (1 << stop));
+                    ++stop;
+                }
+                m_cur += stop;
+                if (stop < 16)
+                    CopyString();
+                continue;
+            }
+#endif
+            if (*m_cur == '\"')
+                CopyString();
+            else
+            {
+                *m_out = *m_cur;
+                m_out += !IsWhitespace(*m_cur);
+                ++m_cur;
+            }
+        }
+        content.resize(m_out - begin);
+    }
+
+    void JsonMinifier::CopyString()
+    {
+        const char *start = m_cur++;
+        for (;;)
+        {
+            m_cur += ScanStringRun(m_cur, m_end, '\"');
+            if (m_cur == m_end)
+                throw(JsonException("parse miss quotation mark"));
+            if (*m_cur == '\"')
+                break;
+            // 转义字符连同后面的一个字节一起跳过，其他字节原样保留
+            m_cur += (*m_cur == '\\' && m_end - m_cur > 1) ? 2 : 1;
+        }
+        ++m_cur;
+        memmove(m_out, start, m_cur - start);
+        m_out += m_cur - start;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef JSONMINIFIER_H
+#define JSONMINIFIER_H
+#include <cstddef>
+#include <string>
+namespace SJson
+{
+    /*
+     * 直接在 json 文本上去掉字符串之外的空白，不建立 JsonValue，数字与字符串的写法原样保留。
+     * 只识别字符串的边界，不检查语法；需要检查时先调用 Json::Validate。字符串没有结束时抛出 "parse miss quotation mark"。
+     */
+    class JsonMinifier
+    {
+    public:
+        JsonMinifier(const char *data, size_t size, std::string &content);
+
+    private:
+        /* 把从开头引号开始的整个字符串追加到结果中 */
+        void CopyString();
+        const char *m_cur;
+        const char *m_end;
+        /* 结果不会比输入长，先按输入的长度分配，写完之后再截断 */
+        char *m_out;
+    };
+}
+#endif // JSONMINIFIER_H
@@ -0,0 +1,187 @@
+#include "JsonMsgPackDecoder.h"
+#include "JsonException.h"
+#include <cmath>
+#include <cstring>
+namespace SJson
+{
+    JsonMsgPackDecoder::JsonMsgPackDecoder(JsonValue &val, const std::string &content, int flags)
+        : m_cur(reinterpret_cast<const unsigned char *>(content.data())),
+          m_end(reinterpret_cast<const unsigned char *>(content.data()) + content.size()),
+          m_zeroCopy((flags & ParseFlag::ZeroCopy) != 0)
+    {
+        val.SetType(JsonType::Null);
+        try
+        {
+            DecodeValue(val);
+            if (m_cur != m_end)
+                throw(JsonException("msgpack root not singular"));
+        }
+        catch (const JsonException &)
+        {
+            val.SetType(JsonType::Null);
+            throw;
+        }
+    }
+
+    void JsonMsgPackDecoder::DecodeValue(JsonValue &val)
+    {
+        Require(1);
+        unsigned char type = *m_cur++;
+        // positive fixint、fixmap、fixarray、fixstr、negative fixint 把值或长度放在类型字节中
+        if (type < 0x80)
+        {
+            val.SetNumber(type);
+            return;
+        }
+        if (type < 0x90)
+        {
+            DecodeObject(type & 0x0F, val);
+            return;
+        }
+        if (type < 0xA0)
+        {
+            DecodeArray(type & 0x0F, val);
+            return;
+        }
+        if (type < 0xC0 || type == 0xD9 || type == 0xDA || type == 0xDB)
+        {
+            std::string_view str = DecodeString(type);
+            if (m_zeroCopy)
+                val.SetStringView(str.data(), str.size());
+            else
+                val.SetString(std::string(str));
+            return;
+        }
+        if (type >= 0xE0)
+        {
+            val.SetNumber(static_cast<int8_t>(type));
+            return;
+        }
+        switch (type)
+        {
+        case 0xC0:
+            val.SetType(JsonType::Null);
+            return;
+        case 0xC2:
+            val.SetType(JsonType::False);
+            return;
+        case 0xC3:
+            val.SetType(JsonType::True);
+            return;
+        // float 32 与 float 64
+        case 0xCA:
+        case 0xCB:
+        {
+            double d;
+            if (type == 0xCA)
+            {
+                uint32_t bits = static_cast<uint32_t>(DecodeBigEndian(4));
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                d = f;
+            }
+            else
+            {
+                uint64_t bits = DecodeBigEndian(8);
+                memcpy(&d, &bits, sizeof(d));
+            }
+            // json 无法表示无穷大与 NaN
+            if (!std::isfinite(d))
+                throw(JsonException("msgpack invalid number"));
+            val.SetNumber(d);
+            return;
+        }
+        // uint 8/16/32/64
+        case 0xCC:
+        case 0xCD:
+        case 0xCE:
+        case 0xCF:
+            val.SetNumber(static_cast<double>(DecodeBigEndian(size_t(1) << (type - 0xCC))));
+            return;
+        // int 8/16/32/64：按补码读取后转换为有符号数
+        case 0xD0:
+            val.SetNumber(static_cast<int8_t>(DecodeBigEndian(1)));
+            return;
+        case 0xD1:
+            val.SetNumber(static_cast<int16_t>(DecodeBigEndian(2)));
+            return;
+        case 0xD2:
+            val.SetNumber(static_cast<int32_t>(DecodeBigEndian(4)));
+            return;
+        case 0xD3:
+            val.SetNumber(static_cast<double>(static_cast<int64_t>(DecodeBigEndian(8))));
+            return;
+        // array 16/32 与 map 16/32
+        case 0xDC:
+            DecodeArray(static_cast<size_t>(DecodeBigEndian(2)), val);
+            return;
+        case 0xDD:
+            DecodeArray(static_cast<size_t>(DecodeBigEndian(4)), val);
+            return;
+        case 0xDE:
+            DecodeObject(static_cast<size_t>(DecodeBigEndian(2)), val);
+            return;
+        case 0xDF:
+            DecodeObject(static_cast<size_t>(DecodeBigEndian(4)), val);
+            return;
+        // bin 与 ext 在 json 中没有对应的类型，0xC1 是保留的类型
+        default:
+            throw(JsonException("msgpack unsupported type"));
+        }
+    }
+
+    std::string_view JsonMsgPackDecoder::DecodeString(unsigned char type)
+    {
+        uint64_t size;
+        if (type < 0xC0)
+            size = type & 0x1F;
+        else
+            size = DecodeBigEndian(size_t(1) << (type - 0xD9));
+        Require(size);
+        std::string_view str(reinterpret_cast<const char *>(m_cur), static_cast<size_t>(size));
+        m_cur += size;
+        return str;
+    }
+
+    void JsonMsgPackDecoder::DecodeArray(size_t size, JsonValue &val)
+    {
+        // 每个元素至少占一个字节，元素个数超过剩余字节数时数据一定不完整
+        Require(size);
+        std::vector<JsonValue> tmp(size);
+        for (auto &element : tmp)
+            DecodeValue(element);
+        val.SetArray(std::move(tmp));
+    }
+
+    void JsonMsgPackDecoder::DecodeObject(size_t size, JsonValue &val)
+    {
+        Require(uint64_t(size) * 2);
+        std::vector<std::pair<JsonKey, JsonValue>> tmp(size);
+        for (auto &member : tmp)
+        {
+            // json 对象的 key 只能是字符串
+            Require(1);
+            unsigned char type = *m_cur++;
+            if (!((type >= 0xA0 && type < 0xC0) || type == 0xD9 || type == 0xDA || type == 0xDB))
+                throw(JsonException("msgpack invalid key"));
+            member.first = std::string(DecodeString(type));
+            DecodeValue(member.second);
+        }
+        val.SetObject(std::move(tmp));
+    }
+
+    uint64_t JsonMsgPackDecoder::DecodeBigEndian(size_t bytes)
+    {
+        Require(bytes);
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+            value = (value << 8) | *m_cur++;
+        return value;
+    }
+
+    void JsonMsgPackDecoder::Require(uint64_t size)
+    {
+        if (size > static_cast<uint64_t>(m_end - m_cur))
+            throw(JsonException("msgpack unexpected end"));
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef JSONMSGPACKDECODER_H
+#define JSONMSGPACKDECODER_H
+#include "JsonValue.h"
+#include <cstdint>
+namespace SJson
+{
+    /* 把 MessagePack 二进制数据解码为 JsonValue */
+    class JsonMsgPackDecoder
+    {
+    public:
+        /* flags 为 ParseFlag::ZeroCopy 时，字符串值直接引用 content 中的字节 */
+        JsonMsgPackDecoder(JsonValue &val, const std::string &content, int flags);
+
+    private:
+        void DecodeValue(JsonValue &val);
+        /* 解码字符串，返回其在输入中的位置与长度 */
+        std::string_view DecodeString(unsigned char type);
+        void DecodeArray(size_t size, JsonValue &val);
+        void DecodeObject(size_t size, JsonValue &val);
+        /* 以大端序读取 bytes 个字节 */
+        uint64_t DecodeBigEndian(size_t bytes);
+        /* 检查剩余的字节数是否至少为 size */
+        void Require(uint64_t size);
+        const unsigned char *m_cur;
+        const unsigned char *m_end;
+        bool m_zeroCopy;
+    };
+}
+#endif // JSONMSGPACKDECODER_H
@@ -0,0 +1,147 @@
+#include "JsonMsgPackEncoder.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+namespace SJson
+{
+    JsonMsgPackEncoder::JsonMsgPackEncoder(const JsonValue &val, std::string &result) : m_res(result)
+    {
+        m_res.clear();
+        EncodeValue(val);
+    }
+
+    void JsonMsgPackEncoder::EncodeValue(const JsonValue &val)
+    {
+        switch (val.GetType())
+        {
+        case JsonType::Null:
+            m_res += static_cast<char>(0xC0);
+            break;
+        case JsonType::True:
+            m_res += static_cast<char>(0xC3);
+            break;
+        case JsonType::False:
+            m_res += static_cast<char>(0xC2);
+            break;
+        case JsonType::Number:
+            EncodeNumber(val.GetNumber());
+            break;
+        case JsonType::String:
+            EncodeString(val.GetString());
+            break;
+        // 二进制格式没有 json 文本，编码解析后的值
+        case JsonType::Raw:
+            EncodeValue(val.ParseRaw());
+            break;
+        // 数组：fixarray 0x90，array 16 0xDC，array 32 0xDD
+        case JsonType::Array:
+            EncodeContainerHead(val.GetArraySize(), 0x90, 0xDC);
+            if (const double *numbers = val.GetArrayNumbers())
+            {
+                for (size_t i = 0; i < val.GetArraySize(); ++i)
+                    EncodeNumber(numbers[i]);
+            }
+            else
+            {
+                for (size_t i = 0; i < val.GetArraySize(); ++i)
+                    EncodeValue(val.GetArrayElement(i));
+            }
+            break;
+        // 对象：fixmap 0x80，map 16 0xDE，map 32 0xDF
+        case JsonType::Object:
+            EncodeContainerHead(val.GetObjectSize(), 0x80, 0xDE);
+            for (size_t i = 0; i < val.GetObjectSize(); ++i)
+            {
+                EncodeString(val.GetObjectKey(i));
+                EncodeValue(val.GetObjectValue(i));
+            }
+            break;
+        default:
+            assert(0 && "invalid type");
+        }
+    }
+
+    void JsonMsgPackEncoder::EncodeNumber(double d)
+    {
+        // 整数使用最短的整数格式，-0 需要保留符号，只能编码为浮点数
+        if (d == std::floor(d) && !(d == 0 && std::signbit(d)))
+        {
+            if (d >= 0 && d < 18446744073709551616.0)
+            {
+                uint64_t u = static_cast<uint64_t>(d);
+                if (u < 0x80)
+                    m_res += static_cast<char>(u); // positive fixint
+                else if (u <= 0xFF)
+                    EncodeTyped(0xCC, u, 1);
+                else if (u <= 0xFFFF)
+                    EncodeTyped(0xCD, u, 2);
+                else if (u <= 0xFFFFFFFF)
+                    EncodeTyped(0xCE, u, 4);
+                else
+                    EncodeTyped(0xCF, u, 8);
+                return;
+            }
+            if (d < 0 && d >= -9223372036854775808.0)
+            {
+                int64_t i = static_cast<int64_t>(d);
+                if (i >= -32)
+                    m_res += static_cast<char>(i); // negative fixint
+                else if (i >= INT8_MIN)
+                    EncodeTyped(0xD0, static_cast<uint64_t>(i), 1);
+                else if (i >= INT16_MIN)
+                    EncodeTyped(0xD1, static_cast<uint64_t>(i), 2);
+                else if (i >= INT32_MIN)
+                    EncodeTyped(0xD2, static_cast<uint64_t>(i), 4);
+                else
+                    EncodeTyped(0xD3, static_cast<uint64_t>(i), 8);
+                return;
+            }
+        }
+        // 能用单精度无损表示的数字使用 float 32，否则使用 float 64
+        float f = static_cast<float>(d);
+        if (static_cast<double>(f) == d)
+        {
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            EncodeTyped(0xCA, bits, 4);
+        }
+        else
+        {
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            EncodeTyped(0xCB, bits, 8);
+        }
+    }
+
+    void JsonMsgPackEncoder::EncodeString(std::string_view str)
+    {
+        // fixstr 0xA0，str 8 0xD9，str 16 0xDA，str 32 0xDB
+        size_t size = str.size();
+        if (size < 32)
+            m_res += static_cast<char>(0xA0 | size);
+        else if (size <= 0xFF)
+            EncodeTyped(0xD9, size, 1);
+        else if (size <= 0xFFFF)
+            EncodeTyped(0xDA, size, 2);
+        else
+            EncodeTyped(0xDB, size, 4);
+        m_res += str;
+    }
+
+    void JsonMsgPackEncoder::EncodeContainerHead(size_t size, unsigned char fix, unsigned char head16)
+    {
+        if (size < 16)
+            m_res += static_cast<char>(fix | size);
+        else if (size <= 0xFFFF)
+            EncodeTyped(head16, size, 2);
+        else
+            EncodeTyped(head16 + 1, size, 4);
+    }
+
+    void JsonMsgPackEncoder::EncodeTyped(unsigned char type, uint64_t value, size_t bytes)
+    {
+        m_res += static_cast<char>(type);
+        for (size_t i = bytes; i > 0; --i)
+            m_res += static_cast<char>((value >> ((i - 1) * 8)) & 0xFF);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef JSONMSGPACKENCODER_H
+#define JSONMSGPACKENCODER_H
+#include "JsonValue.h"
+#include <cstdint>
+namespace SJson
+{
+    /* 把 JsonValue 编码为 MessagePack 二进制格式 */
+    class JsonMsgPackEncoder
+    {
+    public:
+        JsonMsgPackEncoder(const JsonValue &val, std::string &result);
+
+    private:
+        void EncodeValue(const JsonValue &val);
+        void EncodeNumber(double d);
+        void EncodeString(std::string_view str);
+        /* 写入数组或对象的头部：元素少时使用 fix 格式，否则使用 16 位或 32 位长度 */
+        void EncodeContainerHead(size_t size, unsigned char fix, unsigned char head16);
+        /* 写入一个字节的类型标记，再以大端序写入 bytes 个字节 */
+        void EncodeTyped(unsigned char type, uint64_t value, size_t bytes);
+        std::string &m_res;
+    };
+}
+#endif // JSONMSGPACKENCODER_H
@@ -1,20 +1,12 @@
-#include <assert.h>
-#include <ctype.h>
-#include <errno.h>
-#include <math.h>
-#include <stdlib.h>
 #include "JsonParser.h"
 #include "JsonException.h"
 namespace SJson
 {
-    inline void Expect(const char *&c, char ch)
-    {
-        assert(*c == ch);
-        ++c;
-    }
-    JsonParser::JsonParser(JsonValue &val, const std::string &content)
-        : m_val(val), m_cur(content.c_str())
+    JsonParser::JsonParser(JsonValue &val, const std::string &content, JsonKeyTable &keys, int flags)
+        : JsonScanner(content), m_val(val), m_keys(keys), m_lazyNumber((flags & ParseFlag::LazyNumber) != 0),
+          m_zeroCopy((flags & ParseFlag::ZeroCopy) != 0)
     {
+        m_strictUTF8 = (flags & ParseFlag::StrictUTF8) != 0;
         m_val.SetType(JsonType::Null);
         // 去掉Value前面的空白，若 json 在一个值之后，空白之后还有其他字符的话，说明该 json 值是不合法的。
         ParseWhitespace();
@@ -26,12 +18,6 @@ namespace SJson
             throw(JsonException("parse root not singular"));
         }
     }
-    void JsonParser::ParseWhitespace() noexcept
-    {
-        /* 过滤掉 json 字符串中的空白，即空格符、制表符、换行符、回车符 */
-        while (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r')
-            ++m_cur;
-    }
     void JsonParser::ParseValue()
     {
         switch (*m_cur)
@@ -63,195 +49,49 @@ namespace SJson
     }
     void JsonParser::ParseLiteral(const char *literal, JsonType::type t)
     {
-        Expect(m_cur, literal[0]);
-        size_t i;
-        for (i = 0; literal[i + 1]; i++)
-        {                                   // 直到 literal[i+1] 为 '\0'，循环结束
-            if (m_cur[i] != literal[i + 1]) // 解析失败，抛出异常
-                throw(JsonException("parse invalid value"));
-        }
-        // 解析成功，将 m_cur 右移 i 位，然后设置 val_ 的类型为 t
-        m_cur += i;
+        ParseLiteralRaw(literal);
         m_val.SetType(t);
     }
     void JsonParser::ParseNumber()
     {
-        const char *p = m_cur;
-        // 处理负号
-        if (*p == '-')
-            p++;
-
-        // 处理整数部分，分为两种合法情况：一种是单个 0，另一种是一个 1~9 再加上任意数量的 digit。
-        if (*p == '0')
-            p++;
-        else
-        {
-            if (!isdigit(*p))
-                throw(JsonException("parse invalid value"));
-            while (isdigit(*++p))
-                ;
-        }
-
-        // 处理小数部分：小数点后面第一个数不是数字，则抛出异常，然后再处理连续的数字
-        if (*p == '.')
-        {
-            if (!isdigit(*++p))
-                throw(JsonException("parse invalid value"));
-            while (isdigit(*++p))
-                ;
-        }
-
-        // 处理指数部分：需要处理指数的符号，符号之后的第一个字符不是数字，则抛出异常；然后再处理连续的数字
-        if (*p == 'e' || *p == 'E')
+        if (m_lazyNumber)
         {
-            ++p;
-            if (*p == '+' || *p == '-')
-                ++p;
-            if (!isdigit(*p))
-                throw(JsonException("parse invalid value"));
-            while (isdigit(*++p))
-                ;
+            std::string text;
+            ParseNumberText(text);
+            m_val.SetNumberText(std::move(text));
         }
-
-        errno = 0;
-        // 将 json 的十进制数字转换为 double 型的二进制数字
-        double v = strtod(m_cur, NULL);
-        // 如果转换出来的数字过大，则抛出异常
-        if (errno == ERANGE && (v == HUGE_VAL || v == -HUGE_VAL))
-            throw(JsonException("parse number too big"));
-
-        // 最后设置 Value 为数字，然后更新 m_cur 的位置
-        m_val.SetNumber(v);
-        m_cur = p;
+        else
+            m_val.SetNumber(ParseNumberRaw());
     }
     void JsonParser::ParseString()
     {
-        std::string s = "";
-        // 用临时值 s 来保存解析出来的字符串，然后将 s 赋值为 Value
-        ParseStringRaw(s);
-        m_val.SetString(s);
-    }
-    void JsonParser::ParseStringRaw(std::string &tmp)
-    {
-        Expect(m_cur, '\"'); // 跳过字符串的第一个引号
-        const char *p = m_cur;
-        unsigned u = 0, u2 = 0;
-        while (*p != '\"') // 直到解析到字符串结尾，也就是第二个引号
-        {
-            // 字符串的结尾不是双引号，说明该字符串缺少引号，抛出异常即可
-            if (*p == '\0')
-                throw(JsonException("parse miss quotation mark"));
-            // 处理 9 种转义字符：当前字符是'\'，然后跳到下一个字符
-            if (*p == '\\' && ++p)
-            {
-                switch (*p++)
-                {
-                case '\"':
-                    tmp += '\"';
-                    break;
-                case '\\':
-                    tmp += '\\';
-                    break;
-                case '/':
-                    tmp += '/';
-                    break;
-                case 'b':
-                    tmp += '\b';
-                    break;
-                case 'f':
-                    tmp += '\f';
-                    break;
-                case 'n':
-                    tmp += '\n';
-                    break;
-                case 'r':
-                    tmp += '\r';
-                    break;
-                case 't':
-                    tmp += '\t';
-                    break;
-                case 'u':
-                    // 遇到\u转义时，调用parse_hex4()来解析4位十六进制数字
-                    ParseHex4(p, u);
-                    if (u >= 0xD800 && u <= 0xDBFF)
-                    {
-                        if (*p++ != '\\')
-                            throw(JsonException("parse invalid unicode surrogate"));
-                        if (*p++ != 'u')
-                            throw(JsonException("parse invalid unicode surrogate"));
-                        ParseHex4(p, u2);
-                        if (u2 < 0xDC00 || u2 > 0xDFFF)
-                            throw(JsonException("parse invalid unicode surrogate"));
-                        u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
-                    }
-                    // 把码点编码成 utf-8，写进缓冲区
-                    ParseUTF8(tmp, u);
-                    break;
-                default:
-                    throw(JsonException("parse invalid string escape"));
-                }
-            }
-            else if ((unsigned char)*p < 0x20)
-            {
-                throw(JsonException("parse invalid string char"));
-            }
-            else
-                tmp += *p++;
-        }
-        // 更新当前字符串的位置
-        m_cur = ++p;
-    }
-    void JsonParser::ParseHex4(const char *&p, unsigned &u)
-    {
-        u = 0;
-        for (size_t i = 0; i < 4; ++i)
+        // 直接引用输入中的字符串：没有转义时就是字符串的内容，否则保存带引号的原文，读取时才解码
+        if (m_zeroCopy)
         {
-            char ch = *p++;
-            u <<= 4;
-            if (isdigit(ch))
-                u |= ch - '0';
-            else if (ch >= 'A' && ch <= 'F')
-                u |= ch - ('A' - 10);
-            else if (ch >= 'a' && ch <= 'f')
-                u |= ch - ('a' - 10);
+            std::string_view raw;
+            if (ScanStringRaw(raw))
+                m_val.SetEscapedStringView(raw.data() - 1, raw.size() + 2);
             else
-                throw(JsonException("parse invalid unicode hex"));
-        }
-    }
-    void JsonParser::ParseUTF8(std::string &str, unsigned u)
-    {
-        if (u <= 0x7F)
-            str += static_cast<char>(u & 0xFF);
-        else if (u <= 0x7FF)
-        {
-            str += static_cast<char>(0xC0 | ((u >> 6) & 0xFF));
-            str += static_cast<char>(0x80 | (u & 0x3F));
-        }
-        else if (u <= 0xFFFF)
-        {
-            str += static_cast<char>(0xE0 | ((u >> 12) & 0xFF));
-            str += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
-            str += static_cast<char>(0x80 | (u & 0x3F));
-        }
-        else
-        {
-            assert(u <= 0x10FFFF);
-            str += static_cast<char>(0xF0 | ((u >> 18) & 0xFF));
-            str += static_cast<char>(0x80 | ((u >> 12) & 0x3F));
-            str += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
-            str += static_cast<char>(0x80 | (u & 0x3F));
+                m_val.SetStringView(raw.data(), raw.size());
+            return;
         }
+        std::string s = "";
+        // 用临时值 s 来保存解析出来的字符串，然后将 s 赋值为 Value
+        ParseStringRaw(s);
+        m_val.SetString(std::move(s));
     }
-
     void JsonParser::ParseArray()
     {
-        Expect(m_cur, '['); // 处理数字的左括号，然后将当前字符的位置右移一位
+        Expect('[');        // 处理数字的左括号，然后将当前字符的位置右移一位
         ParseWhitespace();  // 第一个解析空白：在左括号之后解析空白
         std::vector<JsonValue> tmp;
+        // 元素全部是数字时只收集 double，生成 packed 数组；遇到其他类型的值时转换为 JsonValue。数字保存原文时不使用 packed 数组
+        std::vector<double> numbers;
+        bool packed = !m_lazyNumber;
         if (*m_cur == ']')
         { // 遇到数组的右括号，然后将当前字符位置右移一位，并将 Value 设置为数组 tmp
             ++m_cur;
-            m_val.SetArray(tmp);
+            m_val.SetArray(std::move(tmp));
             return;
         }
         for (;;)
@@ -266,8 +106,20 @@ namespace SJson
                 m_val.SetType(JsonType::Null);
                 throw;
             }
-            // 将解析出来的值加入到 tmp 后面
-            tmp.push_back(m_val);
+            if (packed && m_val.GetType() == JsonType::Number)
+                numbers.push_back(m_val.GetNumber());
+            else
+            {
+                if (packed)
+                {
+                    tmp.resize(numbers.size());
+                    for (size_t i = 0; i < numbers.size(); ++i)
+                        tmp[i].SetNumber(numbers[i]);
+                    packed = false;
+                }
+                // 将解析出来的值移动到 tmp 后面，不拷贝子树
+                tmp.push_back(std::move(m_val));
+            }
             ParseWhitespace(); // 第二个解析空白：在逗号之后处理空白
 
             // 值之后若为逗号，将当前字符的位置右移一位，然后处理逗号之后的空白
@@ -277,11 +129,14 @@ namespace SJson
                 ParseWhitespace(); // 第三个解析空白：在逗号之后处理空白
             }
 
-            // 值之后若为右括号，则将当前字符的位置右移一位，然后将 val_ 设置为数组 tmp
+            // 值之后若为右括号，则将当前字符的位置右移一位，然后将 val_ 设置为数组
             else if (*m_cur == ']')
             {
                 ++m_cur;
-                m_val.SetArray(tmp);
+                if (packed)
+                    m_val.SetArray(std::move(numbers));
+                else
+                    m_val.SetArray(std::move(tmp));
                 return;
             }
 
@@ -295,16 +150,18 @@ namespace SJson
     }
     void JsonParser::ParseObject()
     {
-        Expect(m_cur, '{'); // 先跳过左花括号
+        Expect('{');        // 先跳过左花括号
         ParseWhitespace();  // 第一个解析空白：在左花括号之后处理空白
-        std::vector<std::pair<std::string, JsonValue>> tmp;
+        // key 和 value 分开收集，解析完之后按 key 序列找到共享的 shape
+        std::vector<const JsonKey *> keys;
+        std::vector<JsonValue> values;
         std::string key;
 
-        // 遇到对象的右花括号，然后将当前字符的位置右移一位，然后 val_ 设置为对象 tmp
+        // 遇到对象的右花括号，然后将当前字符的位置右移一位，然后 val_ 设置为对象
         if (*m_cur == '}')
         {
             ++m_cur;
-            m_val.SetObject(tmp);
+            m_val.SetObject(m_shapes.Find(keys), std::move(values));
             return;
         }
 
@@ -339,9 +196,10 @@ namespace SJson
                 throw;
             }
 
-            // 把解析到的值存入 tmp 中，然后将解析到的 val_ 设置为 null，并将 key 进行清空
-            tmp.push_back(std::make_pair(key, m_val));
-            m_val.SetType(JsonType::Null);
+            // 相同的 key 共享 intern 表中的同一份字符串，值移动到 values 中，移动之后 val_ 变为 null；
+            // key 的缓冲区清空之后留给下一个 key 重复使用
+            keys.push_back(&m_keys.Intern(key));
+            values.push_back(std::move(m_val));
             key.clear();
 
             /* 4、解析 "_,_" 或 "_}" */
@@ -352,9 +210,9 @@ namespace SJson
                 ParseWhitespace(); // 第五个解析空白：处理逗号之后的空白
             }
             else if (*m_cur == '}')
-            { // 处理右花括号：将当前字符的位置右移一位，并设置 val_ 为对象 tmp
+            { // 处理右花括号：将当前字符的位置右移一位，并设置 val_ 为对象
                 ++m_cur;
-                m_val.SetObject(tmp);
+                m_val.SetObject(m_shapes.Find(keys), std::move(values));
                 return;
             }
             else
@@ -364,4 +222,11 @@ namespace SJson
             }
         }
     }
+
+    JsonStringDecoder::JsonStringDecoder(const char *data, size_t size, std::string &result)
+        : JsonScanner(data, data + size)
+    {
+        result.clear();
+        ParseStringRaw(result);
+    }
 }
\ No newline at end of file
@@ -1,18 +1,19 @@
 #ifndef JSONPARSER_H
 #define JSONPARSER_H
 #include "JsonValue.h"
+#include "JsonScanner.h"
+#include "JsonShape.h"
 #include "Json.h"
 
 namespace SJson
 {
-    class JsonParser
+    class JsonParser : private JsonScanner
     {
     public:
-        JsonParser(JsonValue &val, const std::string &content);
+        /* 对象的 key 通过 keys 进行 intern；flags 可以包含 ParseFlag::StrictUTF8、ParseFlag::LazyNumber 与 ParseFlag::ZeroCopy */
+        JsonParser(JsonValue &val, const std::string &content, JsonKeyTable &keys, int flags);
 
     private:
-        /* 处理空白 */
-        void ParseWhitespace() noexcept;
         /* 解析 json 值 */
         void ParseValue();
         /* 合并 false、true、null 的解析函数 */
@@ -21,18 +22,25 @@ namespace SJson
         void ParseNumber();
         /* 解析字符串的函数拆分为两部分，是为了在解析 json 对象的 key 值时，不使用 lept_value 存储键，因为这样会浪费其中的 type 这个无用字段 */
         void ParseString();
-        /* 解析 字符串 */
-        void ParseStringRaw(std::string &tmp);
-        /* 解析Hex */
-        void ParseHex4(const char *&p, unsigned &u);
-        /* 解析utf-8 */
-        void ParseUTF8(std::string &str, unsigned u);
         /* 解析Array */
         void ParseArray();
         /* 解析Object */
         void ParseObject();
         JsonValue &m_val;
-        const char *m_cur;
+        JsonKeyTable &m_keys;
+        /* key 序列相同的对象共享同一个 shape */
+        JsonShapeTable m_shapes;
+        /* 数字只保存原文，不转换为 double */
+        bool m_lazyNumber;
+        /* 字符串引用输入缓冲区，带转义的字符串延迟解码 */
+        bool m_zeroCopy;
+    };
+
+    /* 解码 data 处带引号的 json 字符串原文，原文必须已经检查过 */
+    class JsonStringDecoder : private JsonScanner
+    {
+    public:
+        JsonStringDecoder(const char *data, size_t size, std::string &result);
     };
 }
-#endif // JSONPARSE_H
\ No newline at end of file
+#endif // JSONPARSE_H
@@ -0,0 +1,287 @@
+#include "JsonPatcher.h"
+#include "JsonException.h"
+#include <cassert>
+namespace SJson
+{
+    JsonPatcher::JsonPatcher(JsonValue &doc, const JsonValue &patch) : m_doc(doc)
+    {
+        if (patch.GetType() != JsonType::Array)
+            throw(JsonException("patch invalid operation"));
+        try
+        {
+            for (size_t i = 0, n = patch.GetArraySize(); i < n; ++i)
+                ApplyOperation(patch.GetArrayElement(i));
+        }
+        catch (const JsonException &)
+        {
+            Rollback();
+            throw;
+        }
+    }
+
+    void JsonPatcher::ApplyOperation(const JsonValue &op)
+    {
+        if (op.GetType() != JsonType::Object)
+            throw(JsonException("patch invalid operation"));
+        const std::string_view name = Member(op, "op").GetString();
+        const JsonPointer path(std::string(Member(op, "path").GetString()));
+        if (name == "add")
+            Add(path, JsonValue(Member(op, "value")));
+        else if (name == "remove")
+            Remove(path, false);
+        else if (name == "replace")
+            Replace(path, JsonValue(Member(op, "value")));
+        else if (name == "move" || name == "copy")
+        {
+            const JsonPointer from(std::string(Member(op, "from").GetString()));
+            // from 必须存在，即使移动到原来的位置也要检查
+            const JsonValue *src = from.Resolve(m_doc);
+            if (src == nullptr)
+                throw(JsonException("patch path not found"));
+            if (name == "copy")
+            {
+                Add(path, JsonValue(*src));
+                return;
+            }
+            // from 是 path 的前缀时，不能把值移动到它自己的子节点中
+            size_t n = from.m_tokens.size();
+            bool prefix = n <= path.m_tokens.size();
+            for (size_t i = 0; prefix && i < n; ++i)
+                prefix = from.m_tokens[i].key == path.m_tokens[i].key;
+            if (prefix && n == path.m_tokens.size())
+                return;
+            if (prefix)
+                throw(JsonException("patch invalid path"));
+            JsonValue moved = Remove(from, true);
+            try
+            {
+                Add(path, std::move(moved));
+            }
+            catch (const JsonException &)
+            {
+                // Add 只在成功插入时才取走值并记录撤销，失败时值仍然在 moved 中，交给移除的撤销记录保存
+                m_undo.back().carried = false;
+                m_undo.back().value = std::move(moved);
+                throw;
+            }
+        }
+        else if (name == "test")
+        {
+            const JsonValue *target = path.Resolve(m_doc);
+            if (target == nullptr || *target != Member(op, "value"))
+                throw(JsonException("patch test failed"));
+        }
+        else
+            throw(JsonException("patch invalid operation"));
+    }
+
+    void JsonPatcher::Add(const JsonPointer &path, JsonValue &&val)
+    {
+        const auto &tokens = path.m_tokens;
+        if (tokens.empty())
+        {
+            Replace(path, std::move(val));
+            return;
+        }
+        long long index;
+        JsonValue &parent = Locate(path, index);
+        if (parent.GetType() == JsonType::Object)
+        {
+            // key 已经存在时替换原来的值
+            if (index >= 0)
+            {
+                Replace(path, std::move(val));
+                return;
+            }
+            index = static_cast<long long>(parent.GetObjectSize());
+            parent.InsertObjectValue(static_cast<size_t>(index), tokens.back().key, std::move(val));
+        }
+        else
+        {
+            // "-" 表示追加到数组末尾，下标最大可以等于数组长度
+            if (tokens.back().key == "-")
+                index = static_cast<long long>(parent.GetArraySize());
+            if (index < 0 || index > static_cast<long long>(parent.GetArraySize()))
+                throw(JsonException("patch path not found"));
+            parent.InsertArrayElement(std::move(val), static_cast<size_t>(index));
+        }
+        PushUndo(Undo::Erase, tokens, tokens.size() - 1, static_cast<size_t>(index));
+    }
+
+    JsonValue JsonPatcher::Remove(const JsonPointer &path, bool keep)
+    {
+        const auto &tokens = path.m_tokens;
+        if (tokens.empty())
+            throw(JsonException("patch invalid path"));
+        long long index;
+        JsonValue &parent = Locate(path, index);
+        JsonValue removed;
+        std::string key;
+        if (parent.GetType() == JsonType::Object)
+        {
+            if (index < 0)
+                throw(JsonException("patch path not found"));
+            removed = std::move(parent.MutableObjectValue(static_cast<size_t>(index)));
+            key = parent.GetObjectKey(static_cast<size_t>(index));
+            parent.RemoveObjectValue(static_cast<size_t>(index));
+        }
+        else
+        {
+            if (index < 0 || index >= static_cast<long long>(parent.GetArraySize()))
+                throw(JsonException("patch path not found"));
+            removed = std::move(parent.MutableArrayElement(static_cast<size_t>(index)));
+            parent.EraseArrayElement(static_cast<size_t>(index), 1);
+        }
+        PushUndo(Undo::Insert, tokens, tokens.size() - 1, static_cast<size_t>(index));
+        m_undo.back().key = std::move(key);
+        m_undo.back().carried = keep;
+        if (!keep)
+            m_undo.back().value = std::move(removed);
+        return removed;
+    }
+
+    void JsonPatcher::Replace(const JsonPointer &path, JsonValue &&val)
+    {
+        JsonValue *target = Walk(path.m_tokens, path.m_tokens.size());
+        if (target == nullptr)
+            throw(JsonException("patch path not found"));
+        JsonValue old = std::move(*target);
+        *target = std::move(val);
+        PushUndo(Undo::Assign, path.m_tokens, path.m_tokens.size(), 0);
+        m_undo.back().value = std::move(old);
+    }
+
+    JsonValue *JsonPatcher::Walk(const std::vector<Token> &tokens, size_t count) noexcept
+    {
+        JsonValue *cur = &m_doc;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Token &token = tokens[i];
+            if (cur->GetType() == JsonType::Object)
+            {
+                long long index = cur->FindObjectIndex(token.key, token.hash);
+                if (index < 0)
+                    return nullptr;
+                cur = &cur->MutableObjectValue(static_cast<size_t>(index));
+            }
+            else if (cur->GetType() == JsonType::Array)
+            {
+                if (token.index < 0 || static_cast<size_t>(token.index) >= cur->GetArraySize())
+                    return nullptr;
+                cur = &cur->MutableArrayElement(static_cast<size_t>(token.index));
+            }
+            else
+                return nullptr;
+        }
+        return cur;
+    }
+
+    JsonValue &JsonPatcher::Locate(const JsonPointer &path, long long &index)
+    {
+        const auto &tokens = path.m_tokens;
+        assert(!tokens.empty());
+        JsonValue *parent = Walk(tokens, tokens.size() - 1);
+        if (parent == nullptr)
+            throw(JsonException("patch path not found"));
+        const Token &last = tokens.back();
+        if (parent->GetType() == JsonType::Object)
+            index = parent->FindObjectIndex(last.key, last.hash);
+        else if (parent->GetType() == JsonType::Array)
+            index = last.index;
+        else
+            throw(JsonException("patch path not found"));
+        return *parent;
+    }
+
+    void JsonPatcher::PushUndo(Undo::Kind kind, const std::vector<Token> &tokens, size_t count, size_t index)
+    {
+        m_undo.emplace_back();
+        Undo &undo = m_undo.back();
+        undo.kind = kind;
+        undo.path.assign(tokens.begin(), tokens.begin() + count);
+        undo.index = index;
+    }
+
+    void JsonPatcher::Rollback() noexcept
+    {
+        // 按相反的顺序撤销，被删除或被换下的值暂存在 carry 中，供 move 操作的撤销使用
+        JsonValue carry;
+        for (auto it = m_undo.rbegin(); it != m_undo.rend(); ++it)
+        {
+            JsonValue *target = Walk(it->path, it->path.size());
+            assert(target != nullptr);
+            switch (it->kind)
+            {
+            case Undo::Erase:
+                if (target->GetType() == JsonType::Object)
+                {
+                    carry = std::move(target->MutableObjectValue(it->index));
+                    target->RemoveObjectValue(it->index);
+                }
+                else
+                {
+                    carry = std::move(target->MutableArrayElement(it->index));
+                    target->EraseArrayElement(it->index, 1);
+                }
+                break;
+            case Undo::Insert:
+            {
+                JsonValue &val = it->carried ? carry : it->value;
+                if (target->GetType() == JsonType::Object)
+                    target->InsertObjectValue(it->index, it->key, std::move(val));
+                else
+                    target->InsertArrayElement(std::move(val), it->index);
+            }
+            break;
+            case Undo::Assign:
+                carry = std::move(*target);
+                *target = std::move(it->value);
+                break;
+            }
+        }
+        m_undo.clear();
+    }
+
+    const JsonValue &JsonPatcher::Member(const JsonValue &op, const char *key)
+    {
+        long long index = op.FindObjectIndex(key);
+        if (index < 0)
+            throw(JsonException("patch invalid operation"));
+        const JsonValue &val = op.GetObjectValue(static_cast<size_t>(index));
+        // 除了 value 以外的成员都必须是字符串
+        if (val.GetType() != JsonType::String && std::string_view(key) != "value")
+            throw(JsonException("patch invalid operation"));
+        return val;
+    }
+
+    void JsonPatcher::MergePatch(JsonValue &target, const JsonValue &patch) noexcept
+    {
+        // patch 不是对象时直接替换 target
+        if (patch.GetType() != JsonType::Object)
+        {
+            target = patch;
+            return;
+        }
+        if (target.GetType() != JsonType::Object)
+            target.SetObject(std::vector<std::pair<JsonKey, JsonValue>>{});
+        for (size_t i = 0, n = patch.GetObjectSize(); i < n; ++i)
+        {
+            const std::string &key = patch.GetObjectKey(i);
+            const JsonValue &val = patch.GetObjectValue(i);
+            long long index = target.FindObjectIndex(key);
+            // 值为 null 表示删除这个 key
+            if (val.GetType() == JsonType::Null)
+            {
+                if (index >= 0)
+                    target.RemoveObjectValue(static_cast<size_t>(index));
+                continue;
+            }
+            if (index < 0)
+            {
+                index = static_cast<long long>(target.GetObjectSize());
+                target.InsertObjectValue(static_cast<size_t>(index), key, JsonValue());
+            }
+            MergePatch(target.MutableObjectValue(static_cast<size_t>(index)), val);
+        }
+    }
+}
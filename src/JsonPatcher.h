@@ -0,0 +1,57 @@
+#ifndef JSONPATCHER_H
+#define JSONPATCHER_H
+#include "JsonValue.h"
+#include "JsonPointer.h"
+namespace SJson
+{
+    /*
+     * 在 doc 上原地应用 JSON Patch（RFC 6902）。移除、移动的值通过移动转移，不做深拷贝。
+     * 每个操作都记录一条撤销记录，某个操作失败时按相反的顺序撤销，文档恢复原状后抛出 JsonException。
+     */
+    class JsonPatcher
+    {
+    public:
+        JsonPatcher(JsonValue &doc, const JsonValue &patch);
+        /* JSON Merge Patch（RFC 7386），不会失败 */
+        static void MergePatch(JsonValue &target, const JsonValue &patch) noexcept;
+
+    private:
+        using Token = JsonPointer::Token;
+        struct Undo
+        {
+            enum Kind
+            {
+                /* 撤销插入：删除容器中下标为 index 的成员 */
+                Erase,
+                /* 撤销删除：把 value 插回容器的 index 处 */
+                Insert,
+                /* 撤销替换：换回原来的 value */
+                Assign
+            } kind;
+            /* Erase、Insert 时是容器的路径，Assign 时是被替换的值的路径 */
+            std::vector<Token> path;
+            size_t index = 0;
+            std::string key;
+            JsonValue value;
+            /* move 操作移除的值没有留在撤销记录里，撤销时使用上一条记录取出的值 */
+            bool carried = false;
+        };
+        void ApplyOperation(const JsonValue &op);
+        /* 失败时 val 保持不变，并且不会记录撤销 */
+        void Add(const JsonPointer &path, JsonValue &&val);
+        /* keep 为 true 时返回被移除的值，否则被移除的值保存在撤销记录里 */
+        JsonValue Remove(const JsonPointer &path, bool keep);
+        void Replace(const JsonPointer &path, JsonValue &&val);
+        /* 按前 count 个 token 取得可以修改的值，路径上每一层的序列化缓存都会失效，找不到时返回 nullptr */
+        JsonValue *Walk(const std::vector<Token> &tokens, size_t count) noexcept;
+        /* 取得 path 所在的容器以及最后一个 token 在容器中的下标（可能不存在），容器不存在时抛出 JsonException */
+        JsonValue &Locate(const JsonPointer &path, long long &index);
+        /* 操作的修改都完成之后记录撤销 */
+        void PushUndo(Undo::Kind kind, const std::vector<Token> &tokens, size_t count, size_t index);
+        void Rollback() noexcept;
+        static const JsonValue &Member(const JsonValue &op, const char *key);
+        JsonValue &m_doc;
+        std::vector<Undo> m_undo;
+    };
+}
+#endif // JSONPATCHER_H
@@ -0,0 +1,568 @@
+#include "JsonPath.h"
+#include "JsonValue.h"
+#include "JsonScanner.h"
+#include "JsonException.h"
+#include <stdlib.h>
+namespace SJson
+{
+    /* 过滤器表达式的语法树 */
+    struct JsonPath::FilterExpr
+    {
+        /* 比较的一边：单值路径或者字面量 */
+        struct Operand
+        {
+            bool isPath = false;
+            /* 以 $ 开头的路径从根开始，以 @ 开头的路径从当前值开始 */
+            bool absolute = false;
+            std::vector<Segment> path;
+            JsonValue literal;
+            /* 取得操作数的值，路径不存在时返回 nullptr */
+            const JsonValue *Resolve(const JsonValue &cur, const JsonValue &root) const noexcept;
+        };
+        enum Kind
+        {
+            Or,
+            And,
+            Not,
+            Compare,
+            Exists
+        } kind;
+        enum Op
+        {
+            Eq,
+            Ne,
+            Lt,
+            Le,
+            Gt,
+            Ge
+        } op = Eq;
+        std::shared_ptr<const FilterExpr> lhs, rhs;
+        Operand left, right;
+    };
+
+    /* 把 JSONPath 文本编译为 Segment 列表，语法错误时抛出 JsonException */
+    class JsonPathCompiler : private JsonScanner
+    {
+    public:
+        JsonPathCompiler(const std::string &expr, std::vector<JsonPath::Segment> &segments);
+
+    private:
+        using Segment = JsonPath::Segment;
+        using Selector = JsonPath::Selector;
+        using FilterExpr = JsonPath::FilterExpr;
+        /* 解析 $ 或 @ 之后的若干段 */
+        void ParseSegments(std::vector<Segment> &segments);
+        /* 解析 . 之后的 * 或者 name */
+        void ParseDotSelector(Segment &seg);
+        /* 解析 [...] 中逗号分隔的选择器 */
+        void ParseBracket(Segment &seg);
+        void ParseSelector(Selector &sel);
+        /* 解析可选的整数，没有整数时返回 false */
+        bool ParseInteger(long long &value);
+        /* 过滤器：|| 的优先级最低，然后是 &&，最后是 ! 和括号 */
+        std::shared_ptr<const FilterExpr> ParseOr();
+        std::shared_ptr<const FilterExpr> ParseAnd();
+        std::shared_ptr<const FilterExpr> ParseUnary();
+        std::shared_ptr<const FilterExpr> ParseComparison();
+        void ParseOperand(FilterExpr::Operand &operand);
+        /* 参与比较的路径必须最多只能选出一个值：没有递归下降，每段只有一个名字或下标 */
+        static bool IsSingular(const std::vector<Segment> &segments) noexcept;
+        void Fail() { throw(JsonException("path invalid syntax")); }
+    };
+
+    JsonPath::JsonPath(const std::string &expr)
+    {
+        // 查询中的字符串和数字由 JsonScanner 解析，它抛出的异常统一转换为查询的语法错误
+        try
+        {
+            JsonPathCompiler(expr, m_segments);
+        }
+        catch (const JsonException &)
+        {
+            throw(JsonException("path invalid syntax"));
+        }
+    }
+
+    void JsonPath::Evaluate(const JsonValue &root, std::vector<const JsonValue *> &result) const
+    {
+        // 每一段的输入是上一段选出的值，逐段求值
+        std::vector<const JsonValue *> cur{&root}, next;
+        for (auto &seg : m_segments)
+        {
+            next.clear();
+            for (auto val : cur)
+                Apply(seg, *val, root, next);
+            cur.swap(next);
+        }
+        result.insert(result.end(), cur.begin(), cur.end());
+    }
+
+    void JsonPath::Apply(const Segment &seg, const JsonValue &val, const JsonValue &root, std::vector<const JsonValue *> &result)
+    {
+        for (auto &sel : seg.selectors)
+            Select(sel, val, root, result);
+        if (!seg.recursive)
+            return;
+        // 递归下降：先处理值本身，再按顺序处理它的每个后代
+        if (val.GetType() == JsonType::Array)
+        {
+            for (size_t i = 0, n = val.GetArraySize(); i < n; ++i)
+                Apply(seg, val.GetArrayElement(i), root, result);
+        }
+        else if (val.GetType() == JsonType::Object)
+        {
+            for (size_t i = 0, n = val.GetObjectSize(); i < n; ++i)
+                Apply(seg, val.GetObjectValue(i), root, result);
+        }
+    }
+
+    void JsonPath::Select(const Selector &sel, const JsonValue &val, const JsonValue &root, std::vector<const JsonValue *> &result)
+    {
+        const int type = val.GetType();
+        const long long size = type == JsonType::Array ? static_cast<long long>(val.GetArraySize()) : 0;
+        switch (sel.kind)
+        {
+        case Selector::Name:
+            if (type == JsonType::Object)
+            {
+                long long index = val.FindObjectIndex(sel.name, sel.hash);
+                if (index >= 0)
+                    result.push_back(&val.GetObjectValue(static_cast<size_t>(index)));
+            }
+            break;
+        case Selector::Index:
+            if (type == JsonType::Array)
+            {
+                // 负数下标从末尾开始计算
+                long long index = sel.start < 0 ? sel.start + size : sel.start;
+                if (index >= 0 && index < size)
+                    result.push_back(&val.GetArrayElement(static_cast<size_t>(index)));
+            }
+            break;
+        case Selector::Slice:
+            if (type == JsonType::Array && sel.step != 0)
+            {
+                // 与 Python 的切片相同：负数从末尾开始计算，然后截断到数组的范围内
+                auto normalize = [size](long long i, long long lo, long long hi) {
+                    i = i < 0 ? i + size : i;
+                    return i < lo ? lo : (i > hi ? hi : i);
+                };
+                if (sel.step > 0)
+                {
+                    long long lower = sel.hasStart ? normalize(sel.start, 0, size) : 0;
+                    long long upper = sel.hasEnd ? normalize(sel.end, 0, size) : size;
+                    for (long long i = lower; i < upper; i += sel.step)
+                        result.push_back(&val.GetArrayElement(static_cast<size_t>(i)));
+                }
+                else
+                {
+                    long long upper = sel.hasStart ? normalize(sel.start, -1, size - 1) : size - 1;
+                    long long lower = sel.hasEnd ? normalize(sel.end, -1, size - 1) : -1;
+                    for (long long i = upper; i > lower; i += sel.step)
+                        result.push_back(&val.GetArrayElement(static_cast<size_t>(i)));
+                }
+            }
+            break;
+        case Selector::Wildcard:
+        case Selector::Filter:
+            if (type == JsonType::Array)
+            {
+                for (size_t i = 0, n = val.GetArraySize(); i < n; ++i)
+                {
+                    const JsonValue &child = val.GetArrayElement(i);
+                    if (sel.kind == Selector::Wildcard || Test(*sel.filter, child, root))
+                        result.push_back(&child);
+                }
+            }
+            else if (type == JsonType::Object)
+            {
+                for (size_t i = 0, n = val.GetObjectSize(); i < n; ++i)
+                {
+                    const JsonValue &child = val.GetObjectValue(i);
+                    if (sel.kind == Selector::Wildcard || Test(*sel.filter, child, root))
+                        result.push_back(&child);
+                }
+            }
+            break;
+        }
+    }
+
+    /* 大小只对两个数字或两个字符串有意义，其他情况下 < 总是为假 */
+    static bool FilterLess(const JsonValue *lhs, const JsonValue *rhs) noexcept
+    {
+        if (lhs == nullptr || rhs == nullptr || lhs->GetType() != rhs->GetType())
+            return false;
+        if (lhs->GetType() == JsonType::Number)
+            return lhs->GetNumber() < rhs->GetNumber();
+        if (lhs->GetType() == JsonType::String)
+            return lhs->GetString() < rhs->GetString();
+        return false;
+    }
+
+    /* 两边都不存在时相等，只有一边不存在时不相等 */
+    static bool FilterEqual(const JsonValue *lhs, const JsonValue *rhs) noexcept
+    {
+        if (lhs == nullptr || rhs == nullptr)
+            return lhs == rhs;
+        return *lhs == *rhs;
+    }
+
+    bool JsonPath::Test(const FilterExpr &expr, const JsonValue &cur, const JsonValue &root)
+    {
+        switch (expr.kind)
+        {
+        case FilterExpr::Or:
+            return Test(*expr.lhs, cur, root) || Test(*expr.rhs, cur, root);
+        case FilterExpr::And:
+            return Test(*expr.lhs, cur, root) && Test(*expr.rhs, cur, root);
+        case FilterExpr::Not:
+            return !Test(*expr.lhs, cur, root);
+        case FilterExpr::Exists:
+        {
+            // 存在性测试的路径可以选出多个值，只要有一个就为真
+            std::vector<const JsonValue *> nodes{expr.left.absolute ? &root : &cur}, next;
+            for (auto &seg : expr.left.path)
+            {
+                next.clear();
+                for (auto val : nodes)
+                    Apply(seg, *val, root, next);
+                nodes.swap(next);
+            }
+            return !nodes.empty();
+        }
+        case FilterExpr::Compare:
+        {
+            const JsonValue *lhs = expr.left.Resolve(cur, root);
+            const JsonValue *rhs = expr.right.Resolve(cur, root);
+            switch (expr.op)
+            {
+            case FilterExpr::Eq:
+                return FilterEqual(lhs, rhs);
+            case FilterExpr::Ne:
+                return !FilterEqual(lhs, rhs);
+            case FilterExpr::Lt:
+                return FilterLess(lhs, rhs);
+            case FilterExpr::Le:
+                return FilterLess(lhs, rhs) || FilterEqual(lhs, rhs);
+            case FilterExpr::Gt:
+                return FilterLess(rhs, lhs);
+            case FilterExpr::Ge:
+                return FilterLess(rhs, lhs) || FilterEqual(lhs, rhs);
+            }
+        }
+        }
+        return false;
+    }
+
+    const JsonValue *JsonPath::FilterExpr::Operand::Resolve(const JsonValue &cur, const JsonValue &root) const noexcept
+    {
+        if (!isPath)
+            return &literal;
+        const JsonValue *val = absolute ? &root : &cur;
+        for (auto &seg : path)
+        {
+            const Selector &sel = seg.selectors[0];
+            if (sel.kind == Selector::Name)
+            {
+                if (val->GetType() != JsonType::Object)
+                    return nullptr;
+                long long index = val->FindObjectIndex(sel.name, sel.hash);
+                if (index < 0)
+                    return nullptr;
+                val = &val->GetObjectValue(static_cast<size_t>(index));
+            }
+            else
+            {
+                if (val->GetType() != JsonType::Array)
+                    return nullptr;
+                long long size = static_cast<long long>(val->GetArraySize());
+                long long index = sel.start < 0 ? sel.start + size : sel.start;
+                if (index < 0 || index >= size)
+                    return nullptr;
+                val = &val->GetArrayElement(static_cast<size_t>(index));
+            }
+        }
+        return val;
+    }
+
+    JsonPathCompiler::JsonPathCompiler(const std::string &expr, std::vector<Segment> &segments)
+        : JsonScanner(expr)
+    {
+        if (*m_cur != '$')
+            Fail();
+        ++m_cur;
+        ParseSegments(segments);
+        if (*m_cur != '\0')
+            Fail();
+    }
+
+    void JsonPathCompiler::ParseSegments(std::vector<Segment> &segments)
+    {
+        for (;;)
+        {
+            Segment seg;
+            if (m_cur[0] == '.' && m_cur[1] == '.')
+            {
+                m_cur += 2;
+                seg.recursive = true;
+                if (*m_cur == '[')
+                    ParseBracket(seg);
+                else
+                    ParseDotSelector(seg);
+            }
+            else if (*m_cur == '.')
+            {
+                ++m_cur;
+                ParseDotSelector(seg);
+            }
+            else if (*m_cur == '[')
+                ParseBracket(seg);
+            else
+                return;
+            segments.push_back(std::move(seg));
+        }
+    }
+
+    void JsonPathCompiler::ParseDotSelector(Segment &seg)
+    {
+        Selector sel;
+        if (*m_cur == '*')
+        {
+            ++m_cur;
+            sel.kind = Selector::Wildcard;
+            seg.selectors.push_back(std::move(sel));
+            return;
+        }
+        // 简写的名字由字母、数字、下划线和非 ASCII 字符组成，不能以数字开头
+        auto isNameChar = [](unsigned char ch, bool first) {
+            return ch == '_' || ch >= 0x80 || (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
+                   (!first && ch >= '0' && ch <= '9');
+        };
+        const char *begin = m_cur;
+        while (isNameChar(static_cast<unsigned char>(*m_cur), m_cur == begin))
+            ++m_cur;
+        if (m_cur == begin)
+            Fail();
+        sel.kind = Selector::Name;
+        sel.name.assign(begin, m_cur);
+        sel.hash = JsonValue::HashKey(sel.name);
+        seg.selectors.push_back(std::move(sel));
+    }
+
+    void JsonPathCompiler::ParseBracket(Segment &seg)
+    {
+        Expect('[');
+        for (;;)
+        {
+            ParseWhitespace();
+            seg.selectors.emplace_back();
+            ParseSelector(seg.selectors.back());
+            ParseWhitespace();
+            if (*m_cur == ']')
+            {
+                ++m_cur;
+                return;
+            }
+            if (*m_cur != ',')
+                Fail();
+            ++m_cur;
+        }
+    }
+
+    void JsonPathCompiler::ParseSelector(Selector &sel)
+    {
+        switch (*m_cur)
+        {
+        case '\'':
+        case '\"':
+            sel.kind = Selector::Name;
+            ParseStringRaw(sel.name, *m_cur);
+            sel.hash = JsonValue::HashKey(sel.name);
+            return;
+        case '*':
+            ++m_cur;
+            sel.kind = Selector::Wildcard;
+            return;
+        case '?':
+            ++m_cur;
+            sel.kind = Selector::Filter;
+            sel.filter = ParseOr();
+            return;
+        }
+        // 下标或者切片，切片的三个部分都可以省略
+        sel.hasStart = ParseInteger(sel.start);
+        ParseWhitespace();
+        if (*m_cur != ':')
+        {
+            if (!sel.hasStart)
+                Fail();
+            sel.kind = Selector::Index;
+            return;
+        }
+        ++m_cur;
+        sel.kind = Selector::Slice;
+        ParseWhitespace();
+        sel.hasEnd = ParseInteger(sel.end);
+        ParseWhitespace();
+        if (*m_cur == ':')
+        {
+            ++m_cur;
+            ParseWhitespace();
+            if (!ParseInteger(sel.step))
+                sel.step = 1;
+        }
+    }
+
+    bool JsonPathCompiler::ParseInteger(long long &value)
+    {
+        const char *p = m_cur;
+        if (*p == '-')
+            ++p;
+        if (*p < '0' || *p > '9')
+        {
+            if (p != m_cur)
+                Fail();
+            return false;
+        }
+        char *end;
+        value = strtoll(m_cur, &end, 10);
+        m_cur = end;
+        return true;
+    }
+
+    std::shared_ptr<const JsonPath::FilterExpr> JsonPathCompiler::ParseOr()
+    {
+        auto lhs = ParseAnd();
+        for (;;)
+        {
+            ParseWhitespace();
+            if (m_cur[0] != '|' || m_cur[1] != '|')
+                return lhs;
+            m_cur += 2;
+            auto expr = std::make_shared<FilterExpr>();
+            expr->kind = FilterExpr::Or;
+            expr->lhs = lhs;
+            expr->rhs = ParseAnd();
+            lhs = expr;
+        }
+    }
+
+    std::shared_ptr<const JsonPath::FilterExpr> JsonPathCompiler::ParseAnd()
+    {
+        auto lhs = ParseUnary();
+        for (;;)
+        {
+            ParseWhitespace();
+            if (m_cur[0] != '&' || m_cur[1] != '&')
+                return lhs;
+            m_cur += 2;
+            auto expr = std::make_shared<FilterExpr>();
+            expr->kind = FilterExpr::And;
+            expr->lhs = lhs;
+            expr->rhs = ParseUnary();
+            lhs = expr;
+        }
+    }
+
+    std::shared_ptr<const JsonPath::FilterExpr> JsonPathCompiler::ParseUnary()
+    {
+        ParseWhitespace();
+        if (*m_cur == '!')
+        {
+            ++m_cur;
+            auto expr = std::make_shared<FilterExpr>();
+            expr->kind = FilterExpr::Not;
+            expr->lhs = ParseUnary();
+            return expr;
+        }
+        if (*m_cur == '(')
+        {
+            ++m_cur;
+            auto expr = ParseOr();
+            ParseWhitespace();
+            if (*m_cur != ')')
+                Fail();
+            ++m_cur;
+            return expr;
+        }
+        return ParseComparison();
+    }
+
+    std::shared_ptr<const JsonPath::FilterExpr> JsonPathCompiler::ParseComparison()
+    {
+        auto expr = std::make_shared<FilterExpr>();
+        ParseOperand(expr->left);
+        ParseWhitespace();
+        const char ch = m_cur[0], next = m_cur[1];
+        if (ch == '=' && next == '=')
+            expr->op = FilterExpr::Eq;
+        else if (ch == '!' && next == '=')
+            expr->op = FilterExpr::Ne;
+        else if (ch == '<')
+            expr->op = next == '=' ? FilterExpr::Le : FilterExpr::Lt;
+        else if (ch == '>')
+            expr->op = next == '=' ? FilterExpr::Ge : FilterExpr::Gt;
+        else
+        {
+            // 没有比较运算符时是存在性测试，只能是路径
+            if (!expr->left.isPath)
+                Fail();
+            expr->kind = FilterExpr::Exists;
+            return expr;
+        }
+        m_cur += (next == '=') ? 2 : 1;
+        expr->kind = FilterExpr::Compare;
+        ParseOperand(expr->right);
+        if ((expr->left.isPath && !IsSingular(expr->left.path)) || (expr->right.isPath && !IsSingular(expr->right.path)))
+            Fail();
+        return expr;
+    }
+
+    void JsonPathCompiler::ParseOperand(FilterExpr::Operand &operand)
+    {
+        ParseWhitespace();
+        switch (*m_cur)
+        {
+        case '@':
+        case '$':
+            operand.isPath = true;
+            operand.absolute = *m_cur++ == '$';
+            ParseSegments(operand.path);
+            return;
+        case '\'':
+        case '\"':
+        {
+            std::string str;
+            ParseStringRaw(str, *m_cur);
+            operand.literal.SetString(str);
+            return;
+        }
+        case 't':
+            ParseLiteralRaw("true");
+            operand.literal.SetType(JsonType::True);
+            return;
+        case 'f':
+            ParseLiteralRaw("false");
+            operand.literal.SetType(JsonType::False);
+            return;
+        case 'n':
+            ParseLiteralRaw("null");
+            operand.literal.SetType(JsonType::Null);
+            return;
+        default:
+            operand.literal.SetNumber(ParseNumberRaw());
+        }
+    }
+
+    bool JsonPathCompiler::IsSingular(const std::vector<Segment> &segments) noexcept
+    {
+        for (auto &seg : segments)
+        {
+            if (seg.recursive || seg.selectors.size() != 1)
+                return false;
+            if (seg.selectors[0].kind != Selector::Name && seg.selectors[0].kind != Selector::Index)
+                return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef JSONPATH_H
+#define JSONPATH_H
+#include <memory>
+#include <string>
+#include <vector>
+namespace SJson
+{
+    class JsonValue;
+    /*
+     * JSONPath 查询（RFC 9535 的常用子集），例如 "$.store.book[?(@.price > 10)].title"。
+     * 支持：子节点 .name ['name']、通配符 *、递归下降 ..、下标 [0] [-1]、切片 [start:end:step]、
+     * 多选 [0,'a']，以及过滤器 [?(...)]：以 @ 或 $ 开头的单值路径、字面量、== != < <= > >=、&& || ! 和括号。
+     * 查询在构造时编译一次，之后可以在任意多个文档上重复执行。
+     */
+    class JsonPath final
+    {
+    public:
+        /* 语法错误时抛出 JsonException */
+        explicit JsonPath(const std::string &expr);
+
+        /* 把 root 中匹配的值按文档顺序追加到 result 中，结果是引用，在 root 被修改或销毁之前有效 */
+        void Evaluate(const JsonValue &root, std::vector<const JsonValue *> &result) const;
+
+    private:
+        friend class JsonPathCompiler;
+        struct FilterExpr;
+        /* 选择器：从一个值中选出若干个子值 */
+        struct Selector
+        {
+            enum Kind
+            {
+                Name,
+                Wildcard,
+                Index,
+                Slice,
+                Filter
+            } kind;
+            std::string name;
+            size_t hash = 0;
+            /* Index 的下标，或 Slice 的 start、end、step */
+            long long start = 0, end = 0, step = 1;
+            bool hasStart = false, hasEnd = false;
+            std::shared_ptr<const FilterExpr> filter;
+        };
+        /* 路径中的一段：一组选择器，recursive 表示 ".." 递归下降 */
+        struct Segment
+        {
+            bool recursive = false;
+            std::vector<Selector> selectors;
+        };
+
+        /* 对 val 应用一段路径，递归下降时还要应用到所有后代上 */
+        static void Apply(const Segment &seg, const JsonValue &val, const JsonValue &root, std::vector<const JsonValue *> &result);
+        static void Select(const Selector &sel, const JsonValue &val, const JsonValue &root, std::vector<const JsonValue *> &result);
+        static bool Test(const FilterExpr &expr, const JsonValue &cur, const JsonValue &root);
+
+        std::vector<Segment> m_segments;
+    };
+}
+#endif // JSONPATH_H
@@ -0,0 +1,103 @@
+#include "JsonPointer.h"
+#include "JsonValue.h"
+#include "JsonException.h"
+#include <cassert>
+namespace SJson
+{
+    JsonPointer::JsonPointer(const std::string &path)
+    {
+        if (path.empty())
+            return;
+        if (path[0] != '/')
+            throw(JsonException("pointer invalid syntax"));
+        for (size_t pos = 1;;)
+        {
+            Token token;
+            size_t end = path.find('/', pos);
+            if (end == std::string::npos)
+                end = path.size();
+            for (size_t i = pos; i < end; ++i)
+            {
+                if (path[i] != '~')
+                {
+                    token.key += path[i];
+                    continue;
+                }
+                // "~0" 表示 '~'，"~1" 表示 '/'，其他的 '~' 都是非法的
+                if (i + 1 < end && path[i + 1] == '0')
+                    token.key += '~';
+                else if (i + 1 < end && path[i + 1] == '1')
+                    token.key += '/';
+                else
+                    throw(JsonException("pointer invalid escape"));
+                ++i;
+            }
+            token.hash = JsonValue::HashKey(token.key);
+            // 数组下标是没有前导零的十进制数，"-" 表示末尾之后的位置，查找时总是不存在
+            token.index = -1;
+            const std::string &key = token.key;
+            if (!key.empty() && key.size() <= 18 && (key == "0" || key[0] != '0') &&
+                key.find_first_not_of("0123456789") == std::string::npos)
+                token.index = std::stoll(key);
+            m_tokens.push_back(std::move(token));
+            if (end == path.size())
+                break;
+            pos = end + 1;
+        }
+    }
+
+    size_t JsonPointer::GetTokenSize() const noexcept
+    {
+        return m_tokens.size();
+    }
+
+    const std::string &JsonPointer::GetToken(size_t index) const noexcept
+    {
+        assert(index < m_tokens.size());
+        return m_tokens[index].key;
+    }
+
+    std::string JsonPointer::ToString() const
+    {
+        std::string path;
+        for (auto &token : m_tokens)
+        {
+            path += '/';
+            for (char ch : token.key)
+            {
+                if (ch == '~')
+                    path += "~0";
+                else if (ch == '/')
+                    path += "~1";
+                else
+                    path += ch;
+            }
+        }
+        return path;
+    }
+
+    const JsonValue *JsonPointer::Resolve(const JsonValue &root) const noexcept
+    {
+        // 沿着路径逐层取引用，不拷贝中间的任何一层
+        const JsonValue *cur = &root;
+        for (auto &token : m_tokens)
+        {
+            if (cur->GetType() == JsonType::Object)
+            {
+                long long index = cur->FindObjectIndex(token.key, token.hash);
+                if (index < 0)
+                    return nullptr;
+                cur = &cur->GetObjectValue(static_cast<size_t>(index));
+            }
+            else if (cur->GetType() == JsonType::Array)
+            {
+                if (token.index < 0 || static_cast<size_t>(token.index) >= cur->GetArraySize())
+                    return nullptr;
+                cur = &cur->GetArrayElement(static_cast<size_t>(token.index));
+            }
+            else
+                return nullptr;
+        }
+        return cur;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef JSONPOINTER_H
+#define JSONPOINTER_H
+#include <string>
+#include <vector>
+namespace SJson
+{
+    class JsonValue;
+    /*
+     * JSON Pointer（RFC 6901），例如 "/a/b/0/c"。路径在构造时解析为 token：
+     * 转义已经还原，数组下标已经转换为整数，对象的 key 已经计算好哈希值，之后可以在任意多个文档上重复查找。
+     */
+    class JsonPointer final
+    {
+    public:
+        /* 空路径，指向整个文档 */
+        JsonPointer() noexcept {}
+        /* 语法错误时抛出 JsonException */
+        explicit JsonPointer(const std::string &path);
+
+        size_t GetTokenSize() const noexcept;
+        /* 还原转义后的 token */
+        const std::string &GetToken(size_t index) const noexcept;
+        /* 重新转义为字符串形式 */
+        std::string ToString() const;
+
+        /* 在 root 中查找，找不到时返回 nullptr */
+        const JsonValue *Resolve(const JsonValue &root) const noexcept;
+
+    private:
+        friend class JsonPatcher;
+        struct Token
+        {
+            std::string key;
+            size_t hash;
+            /* token 作为数组下标的值，不是合法的下标时为 -1 */
+            long long index;
+        };
+        std::vector<Token> m_tokens;
+    };
+}
+#endif // JSONPOINTER_H
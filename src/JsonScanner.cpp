@@ -0,0 +1,271 @@
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include "JsonScanner.h"
+#include "JsonException.h"
+#include "JsonUtf8.h"
+namespace SJson
+{
+    void JsonScanner::ParseWhitespace() noexcept
+    {
+        /* 过滤掉 json 字符串中的空白，即空格符、制表符、换行符、回车符 */
+        while (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r')
+            ++m_cur;
+    }
+    void JsonScanner::ParseLiteralRaw(const char *literal)
+    {
+        Expect(literal[0]);
+        size_t i;
+        for (i = 0; literal[i + 1]; i++)
+        {                                   // 直到 literal[i+1] 为 '\0'，循环结束
+            if (m_cur[i] != literal[i + 1]) // 解析失败，抛出异常
+                throw(JsonException("parse invalid value"));
+        }
+        // 解析成功，将 m_cur 右移 i 位
+        m_cur += i;
+    }
+    const char *JsonScanner::ScanNumberRaw(bool &exponent)
+    {
+        const char *p = m_cur;
+        exponent = false;
+        // 处理负号
+        if (*p == '-')
+            p++;
+
+        // 处理整数部分，分为两种合法情况：一种是单个 0，另一种是一个 1~9 再加上任意数量的 digit。
+        if (*p == '0')
+            p++;
+        else
+        {
+            if (!isdigit(*p))
+                throw(JsonException("parse invalid value"));
+            while (isdigit(*++p))
+                ;
+        }
+
+        // 处理小数部分：小数点后面第一个数不是数字，则抛出异常，然后再处理连续的数字
+        if (*p == '.')
+        {
+            if (!isdigit(*++p))
+                throw(JsonException("parse invalid value"));
+            while (isdigit(*++p))
+                ;
+        }
+
+        // 处理指数部分：需要处理指数的符号，符号之后的第一个字符不是数字，则抛出异常；然后再处理连续的数字
+        if (*p == 'e' || *p == 'E')
+        {
+            exponent = true;
+            ++p;
+            if (*p == '+' || *p == '-')
+                ++p;
+            if (!isdigit(*p))
+                throw(JsonException("parse invalid value"));
+            while (isdigit(*++p))
+                ;
+        }
+        return p;
+    }
+    double JsonScanner::ParseNumberRaw()
+    {
+        bool exponent;
+        const char *p = ScanNumberRaw(exponent);
+
+        errno = 0;
+        // 将 json 的十进制数字转换为 double 型的二进制数字
+        double v = strtod(m_cur, NULL);
+        // 如果转换出来的数字过大，则抛出异常
+        if (errno == ERANGE && (v == HUGE_VAL || v == -HUGE_VAL))
+            throw(JsonException("parse number too big"));
+
+        // 最后更新 m_cur 的位置，返回转换出来的数字
+        m_cur = p;
+        return v;
+    }
+    void JsonScanner::ParseNumberText(std::string &text)
+    {
+        const char *start = m_cur;
+        bool exponent;
+        const char *p = ScanNumberRaw(exponent);
+        // 只有带指数或者整数部分超过 308 位的数字才可能超出 double 的范围，只对它们转换一次；
+        // 整数部分不会比整个原文长，原文超过 308 个字符时就转换，符号和小数部分只会让检查偏保守
+        if (exponent || p - start > 308)
+            ParseNumberRaw();
+        text.assign(start, p);
+        m_cur = p;
+    }
+    void JsonScanner::ParseStringRaw(std::string &tmp, char quote)
+    {
+        Expect(quote); // 跳过字符串的第一个引号
+        const char *p = m_cur;
+        while (*p != quote) // 直到解析到字符串结尾，也就是第二个引号
+        {
+            // 不需要处理的连续字节一次性追加
+            size_t run = ScanStringRun(p, m_end, quote);
+            if (run > 0)
+            {
+                tmp.append(p, run);
+                p += run;
+                continue;
+            }
+            // 字符串的结尾不是双引号，说明该字符串缺少引号，抛出异常即可
+            if (*p == '\0')
+                throw(JsonException("parse miss quotation mark"));
+            // 处理转义字符：当前字符是'\'，然后跳到下一个字符
+            if (*p == '\\')
+                ParseEscape(++p, tmp, quote);
+            else if ((unsigned char)*p < 0x20)
+            {
+                throw(JsonException("parse invalid string char"));
+            }
+            else if ((unsigned char)*p >= 0x80 && m_strictUTF8)
+            {
+                size_t len = ParseUTF8Sequence(p);
+                tmp.append(p, len);
+                p += len;
+            }
+            else
+                tmp += *p++;
+        }
+        // 更新当前字符串的位置
+        m_cur = ++p;
+    }
+    bool JsonScanner::ScanStringRaw(std::string_view &raw)
+    {
+        Expect('\"');
+        const char *p = m_cur;
+        bool escaped = false;
+        // 转义只检查，解码出来的字符写入临时缓冲区后丢弃
+        std::string scratch;
+        while (*p != '\"')
+        {
+            p += ScanStringRun(p, m_end, '\"');
+            if (*p == '\"')
+                break;
+            if (*p == '\0')
+                throw(JsonException("parse miss quotation mark"));
+            if (*p == '\\')
+            {
+                ParseEscape(++p, scratch, '\"');
+                scratch.clear();
+                escaped = true;
+            }
+            else if ((unsigned char)*p < 0x20)
+                throw(JsonException("parse invalid string char"));
+            else if ((unsigned char)*p >= 0x80 && m_strictUTF8)
+                p += ParseUTF8Sequence(p);
+            else
+                ++p;
+        }
+        raw = std::string_view(m_cur, p - m_cur);
+        m_cur = ++p;
+        return escaped;
+    }
+    void JsonScanner::ParseEscape(const char *&p, std::string &tmp, char quote)
+    {
+        unsigned u = 0, u2 = 0;
+        // 处理 9 种转义字符，p 指向反斜杠之后的字符
+        switch (*p++)
+        {
+        case '\"':
+            tmp += '\"';
+            break;
+        case '\'':
+            if (quote != '\'')
+                throw(JsonException("parse invalid string escape"));
+            tmp += '\'';
+            break;
+        case '\\':
+            tmp += '\\';
+            break;
+        case '/':
+            tmp += '/';
+            break;
+        case 'b':
+            tmp += '\b';
+            break;
+        case 'f':
+            tmp += '\f';
+            break;
+        case 'n':
+            tmp += '\n';
+            break;
+        case 'r':
+            tmp += '\r';
+            break;
+        case 't':
+            tmp += '\t';
+            break;
+        case 'u':
+            // 遇到\u转义时，调用parse_hex4()来解析4位十六进制数字
+            ParseHex4(p, u);
+            if (u >= 0xD800 && u <= 0xDBFF)
+            {
+                if (*p++ != '\\')
+                    throw(JsonException("parse invalid unicode surrogate"));
+                if (*p++ != 'u')
+                    throw(JsonException("parse invalid unicode surrogate"));
+                ParseHex4(p, u2);
+                if (u2 < 0xDC00 || u2 > 0xDFFF)
+                    throw(JsonException("parse invalid unicode surrogate"));
+                u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
+            }
+            // 把码点编码成 utf-8，写进缓冲区
+            ParseUTF8(tmp, u);
+            break;
+        default:
+            throw(JsonException("parse invalid string escape"));
+        }
+    }
+    size_t JsonScanner::ParseUTF8Sequence(const char *p)
+    {
+        // 输入以 '\0' 结尾，不合法的编码在读到 '\0' 之前就会被发现
+        size_t len = Utf8SequenceLength(reinterpret_cast<const unsigned char *>(p), reinterpret_cast<const unsigned char *>(m_end));
+        if (len == 0)
+            throw(JsonException("parse invalid utf8"));
+        return len;
+    }
+    void JsonScanner::ParseHex4(const char *&p, unsigned &u)
+    {
+        u = 0;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            char ch = *p++;
+            u <<= 4;
+            if (isdigit(ch))
+                u |= ch - '0';
+            else if (ch >= 'A' && ch <= 'F')
+                u |= ch - ('A' - 10);
+            else if (ch >= 'a' && ch <= 'f')
+                u |= ch - ('a' - 10);
+            else
+                throw(JsonException("parse invalid unicode hex"));
+        }
+    }
+    void JsonScanner::ParseUTF8(std::string &str, unsigned u)
+    {
+        if (u <= 0x7F)
+            str += static_cast<char>(u & 0xFF);
+        else if (u <= 0x7FF)
+        {
+            str += static_cast<char>(0xC0 | ((u >> 6) & 0xFF));
+            str += static_cast<char>(0x80 | (u & 0x3F));
+        }
+        else if (u <= 0xFFFF)
+        {
+            str += static_cast<char>(0xE0 | ((u >> 12) & 0xFF));
+            str += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (u & 0x3F));
+        }
+        else
+        {
+            assert(u <= 0x10FFFF);
+            str += static_cast<char>(0xF0 | ((u >> 18) & 0xFF));
+            str += static_cast<char>(0x80 | ((u >> 12) & 0x3F));
+            str += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (u & 0x3F));
+        }
+    }
+}
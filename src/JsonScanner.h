@@ -0,0 +1,53 @@
+#ifndef JSONSCANNER_H
+#define JSONSCANNER_H
+#include <assert.h>
+#include <string>
+#include <string_view>
+
+namespace SJson
+{
+    /* json 文本的词法部分：空白、字面量、数字与字符串，由构建不同结果的解析器共用 */
+    class JsonScanner
+    {
+    protected:
+        /* 解析 content 的全部内容，遇到 '\0' 时视为结束 */
+        explicit JsonScanner(const std::string &content) noexcept
+            : m_cur(content.c_str()), m_end(content.c_str() + content.size()) {}
+        /* 解析 [cur, end) 中的内容，调用者需要保证解析在 end 之前结束 */
+        JsonScanner(const char *cur, const char *end) noexcept : m_cur(cur), m_end(end) {}
+        /* 跳过当前字符，当前字符必须是 ch */
+        void Expect(char ch) noexcept
+        {
+            assert(*m_cur == ch);
+            ++m_cur;
+        }
+        /* 处理空白 */
+        void ParseWhitespace() noexcept;
+        /* 匹配 false、true、null 字面量 */
+        void ParseLiteralRaw(const char *literal);
+        /* 检查数字的语法，返回数字之后的位置，不移动 m_cur；exponent 表示数字是否带指数 */
+        const char *ScanNumberRaw(bool &exponent);
+        /* 解析数字，返回转换后的 double */
+        double ParseNumberRaw();
+        /* 解析数字，只保存数字的原文而不转换，超出 double 范围时同样抛出异常 */
+        void ParseNumberText(std::string &text);
+        /* 解析 字符串，quote 为 '\'' 时解析单引号字符串（JSONPath 中使用），此时允许 \' 转义 */
+        void ParseStringRaw(std::string &tmp, char quote = '\"');
+        /* 只检查双引号字符串而不解码，raw 为两个引号之间仍然转义的原文，返回字符串中是否有转义 */
+        bool ScanStringRaw(std::string_view &raw);
+        /* 解析 p 处的一个转义序列（p 指向反斜杠之后的字符），解码结果追加到 tmp */
+        void ParseEscape(const char *&p, std::string &tmp, char quote);
+        /* 严格模式下检查 p 处的非 ASCII 字符，返回编码的字节数，不合法时抛出异常 */
+        size_t ParseUTF8Sequence(const char *p);
+        /* 解析Hex */
+        void ParseHex4(const char *&p, unsigned &u);
+        /* 解析utf-8 */
+        void ParseUTF8(std::string &str, unsigned u);
+        const char *m_cur;
+        /* 输入的结尾，批量扫描字符串时不会越过这个位置 */
+        const char *m_end;
+        /* 严格模式：字符串中的非 ASCII 字节必须是合法的 UTF-8 编码 */
+        bool m_strictUTF8 = false;
+    };
+}
+#endif // JSONSCANNER_H
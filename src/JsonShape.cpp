@@ -0,0 +1,29 @@
+#include "JsonShape.h"
+namespace SJson
+{
+    std::shared_ptr<JsonShape> JsonShapeTable::Find(const std::vector<const JsonKey *> &keys)
+    {
+        size_t hash = keys.size();
+        for (auto key : keys)
+            hash = hash * 31 + key->GetHash();
+        auto range = m_shapes.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            const std::vector<JsonKey> &shapeKeys = it->second->keys;
+            if (shapeKeys.size() != keys.size())
+                continue;
+            // intern 过的 key 指向同一份字符串，逐个比较地址即可
+            size_t i = 0;
+            while (i < keys.size() && &shapeKeys[i].GetString() == &keys[i]->GetString())
+                ++i;
+            if (i == keys.size())
+                return it->second;
+        }
+        auto shape = std::make_shared<JsonShape>();
+        shape->keys.reserve(keys.size());
+        for (auto key : keys)
+            shape->keys.push_back(*key);
+        m_shapes.emplace(hash, shape);
+        return shape;
+    }
+}
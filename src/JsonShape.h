@@ -0,0 +1,34 @@
+#ifndef JSONSHAPE_H
+#define JSONSHAPE_H
+#include "JsonKeyTable.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+namespace SJson
+{
+    /*
+     * 对象的 key 列表。key 序列相同的对象共享同一个 shape，每个对象只保存自己的 value，
+     * 按 key 查找得到的下标对共享这个 shape 的所有对象都有效。
+     * 被多个对象共享的 shape 不会被修改，对象增删 key 时先复制一份自己的 shape。
+     */
+    struct JsonShape
+    {
+        std::vector<JsonKey> keys;
+        /* key 哈希表：开放寻址，保存下标 + 1，0 表示空位。第一次查找时建立，整体替换，可以被多个线程同时读取 */
+        mutable std::shared_ptr<const std::vector<uint32_t>> keyIndex;
+    };
+
+    /* 解析时使用的 shape 表，把 key 序列相同的对象映射到同一个 shape */
+    class JsonShapeTable
+    {
+    public:
+        /* 返回 key 序列为 keys 的 shape，没有时新建；keys 中的 key 需要来自同一张 JsonKeyTable */
+        std::shared_ptr<JsonShape> Find(const std::vector<const JsonKey *> &keys);
+
+    private:
+        /* 以 key 序列的哈希为索引 */
+        std::unordered_multimap<size_t, std::shared_ptr<JsonShape>> m_shapes;
+    };
+}
+#endif // JSONSHAPE_H
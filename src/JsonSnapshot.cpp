@@ -0,0 +1,327 @@
+#include "JsonSnapshot.h"
+#include "JsonException.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+namespace SJson
+{
+    JsonSnapshotEntry JsonSnapshotNode::Entry() const noexcept
+    {
+        // 使用 memcpy 读取，不要求缓冲区按 8 字节对齐
+        JsonSnapshotEntry entry;
+        memcpy(&entry, m_base + m_offset, sizeof(entry));
+        return entry;
+    }
+
+    int JsonSnapshotNode::GetType() const noexcept
+    {
+        return static_cast<int>(Entry().type);
+    }
+
+    double JsonSnapshotNode::GetNumber() const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::Number);
+        double d;
+        memcpy(&d, &entry.payload, sizeof(d));
+        return d;
+    }
+
+    std::string_view JsonSnapshotNode::GetString() const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::String);
+        return std::string_view(m_base + entry.payload, entry.count);
+    }
+
+    size_t JsonSnapshotNode::GetArraySize() const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::Array);
+        return entry.count;
+    }
+
+    JsonSnapshotNode JsonSnapshotNode::GetArrayElement(size_t index) const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::Array);
+        assert(index < entry.count);
+        return JsonSnapshotNode(m_base, entry.payload + index * sizeof(JsonSnapshotEntry));
+    }
+
+    size_t JsonSnapshotNode::GetObjectSize() const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::Object);
+        return entry.count;
+    }
+
+    std::string_view JsonSnapshotNode::GetObjectKey(size_t index) const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::Object);
+        assert(index < entry.count);
+        return JsonSnapshotNode(m_base, entry.payload + index * sizeof(JsonSnapshotEntry)).GetString();
+    }
+
+    JsonSnapshotNode JsonSnapshotNode::GetObjectValue(size_t index) const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::Object);
+        assert(index < entry.count);
+        return JsonSnapshotNode(m_base, entry.payload + (entry.count + index) * sizeof(JsonSnapshotEntry));
+    }
+
+    long long JsonSnapshotNode::FindObjectIndex(std::string_view key) const noexcept
+    {
+        JsonSnapshotEntry entry = Entry();
+        assert(entry.type == JsonType::Object);
+        const char *order = m_base + entry.payload + entry.count * 2 * sizeof(JsonSnapshotEntry);
+        // 在排序好的下标上二分查找第一个不小于 key 的位置
+        size_t low = 0, high = entry.count;
+        while (low < high)
+        {
+            size_t mid = low + (high - low) / 2;
+            uint32_t index;
+            memcpy(&index, order + mid * sizeof(uint32_t), sizeof(index));
+            if (GetObjectKey(index) < key)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        if (low == entry.count)
+            return -1;
+        uint32_t index;
+        memcpy(&index, order + low * sizeof(uint32_t), sizeof(index));
+        return GetObjectKey(index) == key ? static_cast<long long>(index) : -1;
+    }
+
+    Json JsonSnapshotNode::ToJson() const noexcept
+    {
+        Json ret;
+        switch (GetType())
+        {
+        case JsonType::True:
+            ret.SetBoolean(true);
+            break;
+        case JsonType::False:
+            ret.SetBoolean(false);
+            break;
+        case JsonType::Number:
+            ret.SetNumber(GetNumber());
+            break;
+        case JsonType::String:
+            ret.SetString(std::string(GetString()));
+            break;
+        case JsonType::Array:
+            ret.SetArray();
+            ret.ReserveArray(GetArraySize());
+            for (size_t i = 0, n = GetArraySize(); i < n; ++i)
+                ret.PushbackArrayElement(GetArrayElement(i).ToJson());
+            break;
+        case JsonType::Object:
+            ret.SetObject();
+            ret.ReserveObject(GetObjectSize());
+            for (size_t i = 0, n = GetObjectSize(); i < n; ++i)
+                ret.EmplaceObjectValue(std::string(GetObjectKey(i)), GetObjectValue(i).ToJson());
+            break;
+        }
+        return ret;
+    }
+
+    JsonSnapshot::JsonSnapshot() noexcept {}
+
+    JsonSnapshot::~JsonSnapshot() noexcept
+    {
+        Close();
+    }
+
+    JsonSnapshot::JsonSnapshot(JsonSnapshot &&rhs) noexcept
+    {
+        *this = std::move(rhs);
+    }
+
+    JsonSnapshot &JsonSnapshot::operator=(JsonSnapshot &&rhs) noexcept
+    {
+        if (this == &rhs)
+            return *this;
+        Close();
+        std::swap(m_data, rhs.m_data);
+        std::swap(m_size, rhs.m_size);
+        std::swap(m_mapping, rhs.m_mapping);
+#ifdef _WIN32
+        std::swap(m_file, rhs.m_file);
+        std::swap(m_map, rhs.m_map);
+#endif
+        return *this;
+    }
+
+    void JsonSnapshot::Open(const std::string &path)
+    {
+        Close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            throw(JsonException("snapshot open failed"));
+        LARGE_INTEGER size;
+        HANDLE map = NULL;
+        void *mapping = NULL;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (map != NULL)
+            mapping = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+        if (mapping == NULL)
+        {
+            if (map != NULL)
+                CloseHandle(map);
+            CloseHandle(file);
+            throw(JsonException("snapshot open failed"));
+        }
+        m_file = file;
+        m_map = map;
+        m_mapping = mapping;
+        m_size = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw(JsonException("snapshot open failed"));
+        struct stat st;
+        void *mapping = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+            mapping = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        // 映射建立之后就可以关闭文件描述符
+        close(fd);
+        if (mapping == MAP_FAILED)
+            throw(JsonException("snapshot open failed"));
+        m_mapping = mapping;
+        m_size = static_cast<size_t>(st.st_size);
+#endif
+        m_data = static_cast<const char *>(m_mapping);
+        try
+        {
+            Check(m_data, m_size);
+        }
+        catch (const JsonException &)
+        {
+            Close();
+            throw;
+        }
+    }
+
+    void JsonSnapshot::Load(const char *data, size_t size)
+    {
+        Close();
+        Check(data, size);
+        m_data = data;
+        m_size = size;
+    }
+
+    void JsonSnapshot::Close() noexcept
+    {
+        if (m_mapping != nullptr)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(m_mapping);
+            CloseHandle(m_map);
+            CloseHandle(m_file);
+            m_map = nullptr;
+            m_file = nullptr;
+#else
+            munmap(m_mapping, m_size);
+#endif
+            m_mapping = nullptr;
+        }
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    JsonSnapshotNode JsonSnapshot::Root() const noexcept
+    {
+        assert(m_data != nullptr);
+        return JsonSnapshotNode(m_data, offsetof(JsonSnapshotHeader, root));
+    }
+
+    void JsonSnapshot::Check(const char *data, size_t size)
+    {
+        JsonSnapshotHeader header;
+        if (size < sizeof(header))
+            throw(JsonException("snapshot invalid header"));
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, "SJSNAPSH", sizeof(header.magic)) != 0 || header.version != 1)
+            throw(JsonException("snapshot invalid header"));
+        if (header.byteOrder != 0x01020304)
+            throw(JsonException("snapshot byte order mismatch"));
+        if (header.size != size)
+            throw(JsonException("snapshot size mismatch"));
+
+        // 遍历一遍节点表，保证读取时所有偏移和长度都落在 [0, size) 之内
+        // 写入时子节点块总在父节点之后追加，且节点块不会共享，因此要求子节点块位于父节点之后，
+        // 并限制访问的节点总数不超过文件能容纳的节点数，损坏的文件既不会成环也不会被重复展开
+        const size_t entrySize = sizeof(JsonSnapshotEntry);
+        size_t budget = size / entrySize;
+        std::vector<uint64_t> stack(1, offsetof(JsonSnapshotHeader, root));
+        while (!stack.empty())
+        {
+            uint64_t offset = stack.back();
+            stack.pop_back();
+            if (budget-- == 0)
+                throw(JsonException("snapshot invalid node"));
+            JsonSnapshotEntry entry;
+            memcpy(&entry, data + offset, entrySize);
+            uint64_t end = offset + entrySize;
+            switch (entry.type)
+            {
+            case JsonType::Null:
+            case JsonType::True:
+            case JsonType::False:
+            case JsonType::Number:
+                break;
+            case JsonType::String:
+                if (entry.payload > size || entry.count > size - entry.payload)
+                    throw(JsonException("snapshot invalid node"));
+                break;
+            case JsonType::Array:
+                if (entry.payload < end || entry.payload > size || entry.count > (size - entry.payload) / entrySize)
+                    throw(JsonException("snapshot invalid node"));
+                for (size_t i = entry.count; i > 0; --i)
+                    stack.push_back(entry.payload + (i - 1) * entrySize);
+                break;
+            case JsonType::Object:
+            {
+                const size_t pairSize = 2 * entrySize + sizeof(uint32_t);
+                if (entry.payload < end || entry.payload > size || entry.count > (size - entry.payload) / pairSize)
+                    throw(JsonException("snapshot invalid node"));
+                const char *order = data + entry.payload + entry.count * 2 * entrySize;
+                for (size_t i = 0; i < entry.count; ++i)
+                {
+                    JsonSnapshotEntry key;
+                    memcpy(&key, data + entry.payload + i * entrySize, entrySize);
+                    if (key.type != JsonType::String)
+                        throw(JsonException("snapshot invalid node"));
+                    uint32_t index;
+                    memcpy(&index, order + i * sizeof(uint32_t), sizeof(index));
+                    if (index >= entry.count)
+                        throw(JsonException("snapshot invalid node"));
+                }
+                for (size_t i = entry.count * 2; i > 0; --i)
+                    stack.push_back(entry.payload + (i - 1) * entrySize);
+            }
+            break;
+            default:
+                throw(JsonException("snapshot invalid node"));
+            }
+        }
+    }
+}
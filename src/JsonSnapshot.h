@@ -0,0 +1,87 @@
+#ifndef JSONSNAPSHOT_H
+#define JSONSNAPSHOT_H
+#include "Json.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace SJson
+{
+    /*
+     * 快照是整个 json 文档的二进制布局，由 Json::ToSnapshot 生成，可以用 mmap 打开后直接查询，不需要解析和分配内存。
+     * 布局：文件头（包含根节点） + 节点 + 字符串表，所有引用都是相对文件开头的偏移，因此与加载地址无关。
+     * 每个节点 16 字节：类型、个数或长度、数字的二进制或子节点/字符串的偏移。
+     * 对象的子节点块依次存放 n 个 key 节点、n 个 value 节点，以及按 key 排序后的下标，用于二分查找。
+     */
+    struct JsonSnapshotEntry
+    {
+        uint32_t type;
+        uint32_t count;
+        uint64_t payload;
+    };
+    struct JsonSnapshotHeader
+    {
+        char magic[8];
+        /* 写入 0x01020304，用来检查读写两端的字节序是否一致 */
+        uint32_t byteOrder;
+        uint32_t version;
+        uint64_t size;
+        JsonSnapshotEntry root;
+    };
+
+    /* 快照中的一个值，只在所属的 JsonSnapshot 打开期间有效 */
+    class JsonSnapshotNode
+    {
+    public:
+        int GetType() const noexcept;
+        double GetNumber() const noexcept;
+        std::string_view GetString() const noexcept;
+        size_t GetArraySize() const noexcept;
+        JsonSnapshotNode GetArrayElement(size_t index) const noexcept;
+        size_t GetObjectSize() const noexcept;
+        std::string_view GetObjectKey(size_t index) const noexcept;
+        JsonSnapshotNode GetObjectValue(size_t index) const noexcept;
+        /* 利用排序好的 key 下标二分查找，找不到时返回 -1 */
+        long long FindObjectIndex(std::string_view key) const noexcept;
+        /* 拷贝为可修改的 Json */
+        Json ToJson() const noexcept;
+
+    private:
+        friend class JsonSnapshot;
+        JsonSnapshotNode(const char *base, uint64_t offset) noexcept : m_base(base), m_offset(offset) {}
+        JsonSnapshotEntry Entry() const noexcept;
+        const char *m_base;
+        uint64_t m_offset;
+    };
+
+    class JsonSnapshot final
+    {
+    public:
+        JsonSnapshot() noexcept;
+        ~JsonSnapshot() noexcept;
+        JsonSnapshot(const JsonSnapshot &) = delete;
+        JsonSnapshot &operator=(const JsonSnapshot &) = delete;
+        JsonSnapshot(JsonSnapshot &&rhs) noexcept;
+        JsonSnapshot &operator=(JsonSnapshot &&rhs) noexcept;
+
+        /* 用 mmap 打开快照文件，多个进程打开同一个文件时共享内存页 */
+        void Open(const std::string &path);
+        /* 使用内存中的快照，data 必须比 JsonSnapshot 活得更久 */
+        void Load(const char *data, size_t size);
+        void Close() noexcept;
+        JsonSnapshotNode Root() const noexcept;
+
+    private:
+        /* 检查文件头，并遍历节点表检查所有偏移和长度都在文件范围内，失败时抛出 JsonException */
+        void Check(const char *data, size_t size);
+        const char *m_data = nullptr;
+        size_t m_size = 0;
+        /* Open 映射的内存，需要在 Close 时解除映射 */
+        void *m_mapping = nullptr;
+#ifdef _WIN32
+        void *m_file = nullptr;
+        void *m_map = nullptr;
+#endif
+    };
+}
+#endif // JSONSNAPSHOT_H
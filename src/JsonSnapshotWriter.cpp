@@ -0,0 +1,105 @@
+#include "JsonSnapshotWriter.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+namespace SJson
+{
+    JsonSnapshotWriter::JsonSnapshotWriter(const JsonValue &val, std::string &result) : m_res(result)
+    {
+        m_res.clear();
+        JsonSnapshotHeader header = {};
+        memcpy(header.magic, "SJSNAPSH", sizeof(header.magic));
+        header.byteOrder = 0x01020304;
+        header.version = 1;
+        m_res.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        // 根节点直接放在文件头中，写完所有节点之后再补上文件的总长度
+        WriteNode(val, offsetof(JsonSnapshotHeader, root));
+        uint64_t size = m_res.size();
+        memcpy(&m_res[offsetof(JsonSnapshotHeader, size)], &size, sizeof(size));
+    }
+
+    void JsonSnapshotWriter::WriteNode(const JsonValue &val, size_t offset)
+    {
+        JsonSnapshotEntry entry = {static_cast<uint32_t>(val.GetType()), 0, 0};
+        switch (val.GetType())
+        {
+        case JsonType::Number:
+        {
+            double d = val.GetNumber();
+            memcpy(&entry.payload, &d, sizeof(d));
+        }
+        break;
+        case JsonType::String:
+            WriteString(val.GetString(), offset);
+            return;
+        // 快照中保存解析后的值，读取时不需要再解析，解析结果要保留到写完为止，字符串表中的 key 可能指向它
+        case JsonType::Raw:
+            m_raws.push_back(val.ParseRaw());
+            WriteNode(m_raws.back(), offset);
+            return;
+        // 数组的子节点连续存放，下标为 i 的元素位于 payload + 16 * i
+        case JsonType::Array:
+        {
+            size_t size = val.GetArraySize();
+            assert(size <= UINT32_MAX);
+            size_t block = Reserve(size * sizeof(JsonSnapshotEntry));
+            entry.count = static_cast<uint32_t>(size);
+            entry.payload = block;
+            for (size_t i = 0; i < size; ++i)
+                WriteNode(val.GetArrayElement(i), block + i * sizeof(JsonSnapshotEntry));
+        }
+        break;
+        // 对象的子节点块：n 个 key 节点，n 个 value 节点，n 个按 key 排序的下标
+        case JsonType::Object:
+        {
+            size_t size = val.GetObjectSize();
+            assert(size <= UINT32_MAX);
+            size_t block = Reserve(size * 2 * sizeof(JsonSnapshotEntry) + size * sizeof(uint32_t));
+            entry.count = static_cast<uint32_t>(size);
+            entry.payload = block;
+            std::vector<uint32_t> order(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                order[i] = static_cast<uint32_t>(i);
+                WriteString(val.GetObjectKey(i), block + i * sizeof(JsonSnapshotEntry));
+                WriteNode(val.GetObjectValue(i), block + (size + i) * sizeof(JsonSnapshotEntry));
+            }
+            // 稳定排序，key 重复时查找到的是第一次出现的键值对
+            std::stable_sort(order.begin(), order.end(), [&val](uint32_t a, uint32_t b)
+                             { return val.GetObjectKey(a) < val.GetObjectKey(b); });
+            if (size > 0)
+                memcpy(&m_res[block + size * 2 * sizeof(JsonSnapshotEntry)], order.data(), size * sizeof(uint32_t));
+        }
+        break;
+        }
+        Store(offset, entry);
+    }
+
+    void JsonSnapshotWriter::WriteString(std::string_view str, size_t offset)
+    {
+        assert(str.size() <= UINT32_MAX);
+        auto it = m_strings.find(str);
+        if (it == m_strings.end())
+        {
+            // 字符串末尾多写一个 '\0'，方便按 C 字符串使用
+            size_t pos = Reserve(str.size() + 1);
+            memcpy(&m_res[pos], str.data(), str.size());
+            it = m_strings.emplace(str, pos).first;
+        }
+        Store(offset, JsonSnapshotEntry{JsonType::String, static_cast<uint32_t>(str.size()), it->second});
+    }
+
+    size_t JsonSnapshotWriter::Reserve(size_t size)
+    {
+        m_res.append((8 - m_res.size() % 8) % 8, '\0');
+        size_t offset = m_res.size();
+        m_res.append(size, '\0');
+        return offset;
+    }
+
+    void JsonSnapshotWriter::Store(size_t offset, const JsonSnapshotEntry &entry)
+    {
+        memcpy(&m_res[offset], &entry, sizeof(entry));
+    }
+}
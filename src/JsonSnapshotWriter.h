@@ -0,0 +1,29 @@
+#ifndef JSONSNAPSHOTWRITER_H
+#define JSONSNAPSHOTWRITER_H
+#include "JsonValue.h"
+#include "JsonSnapshot.h"
+#include <deque>
+#include <unordered_map>
+namespace SJson
+{
+    /* 把 JsonValue 写成快照格式 */
+    class JsonSnapshotWriter
+    {
+    public:
+        JsonSnapshotWriter(const JsonValue &val, std::string &result);
+
+    private:
+        /* 把 val 写入位于 offset 的节点 */
+        void WriteNode(const JsonValue &val, size_t offset);
+        /* 写入字符串节点，字符串表中相同的字符串只保存一份 */
+        void WriteString(std::string_view str, size_t offset);
+        /* 在末尾预留 size 字节并按 8 字节对齐，返回预留区域的偏移 */
+        size_t Reserve(size_t size);
+        void Store(size_t offset, const JsonSnapshotEntry &entry);
+        std::string &m_res;
+        std::unordered_map<std::string_view, uint64_t> m_strings;
+        /* Raw 值解析后的结果，m_strings 中的 key 可能指向它们；deque 追加时不会移动已有元素 */
+        std::deque<JsonValue> m_raws;
+    };
+}
+#endif // JSONSNAPSHOTWRITER_H
@@ -0,0 +1,207 @@
+#include "JsonTape.h"
+#include "JsonTapeParser.h"
+#include "JsonException.h"
+#include <cassert>
+#include <cstring>
+namespace SJson
+{
+    uint64_t JsonTapeNode::Word(size_t index) const noexcept
+    {
+        assert(index < m_doc->m_tape.size());
+        return m_doc->m_tape[index];
+    }
+
+    int JsonTapeNode::GetType() const noexcept
+    {
+        switch (Word(m_index) >> 56)
+        {
+        case JsonTapeTag::True:
+            return JsonType::True;
+        case JsonTapeTag::False:
+            return JsonType::False;
+        case JsonTapeTag::Number:
+            return JsonType::Number;
+        case JsonTapeTag::String:
+            return JsonType::String;
+        case JsonTapeTag::ArrayStart:
+            return JsonType::Array;
+        case JsonTapeTag::ObjectStart:
+            return JsonType::Object;
+        default:
+            return JsonType::Null;
+        }
+    }
+
+    double JsonTapeNode::GetNumber() const noexcept
+    {
+        assert(GetType() == JsonType::Number);
+        uint64_t bits = Word(m_index + 1);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    std::string_view JsonTapeNode::GetString() const noexcept
+    {
+        assert(GetType() == JsonType::String);
+        size_t offset = static_cast<size_t>(Word(m_index) & ((uint64_t(1) << 56) - 1));
+        uint32_t size;
+        memcpy(&size, m_doc->m_strings.data() + offset, sizeof(size));
+        return std::string_view(m_doc->m_strings.data() + offset + sizeof(size), size);
+    }
+
+    size_t JsonTapeNode::GetArraySize() const noexcept
+    {
+        assert(GetType() == JsonType::Array);
+        size_t count = static_cast<size_t>((Word(m_index) >> 32) & kTapeCountMax);
+        if (count < kTapeCountMax)
+            return count;
+        // 元素个数超出了开始标记能记录的范围，需要遍历
+        count = 0;
+        for (JsonTapeNode it = First(); !it.IsEnd(); it = it.Next())
+            ++count;
+        return count;
+    }
+
+    JsonTapeNode JsonTapeNode::GetArrayElement(size_t index) const noexcept
+    {
+        assert(GetType() == JsonType::Array);
+        JsonTapeNode it = First();
+        for (; index > 0; --index)
+            it = it.Next();
+        assert(!it.IsEnd());
+        return it;
+    }
+
+    size_t JsonTapeNode::GetObjectSize() const noexcept
+    {
+        assert(GetType() == JsonType::Object);
+        size_t count = static_cast<size_t>((Word(m_index) >> 32) & kTapeCountMax);
+        if (count < kTapeCountMax)
+            return count;
+        count = 0;
+        for (JsonTapeNode it = First(); !it.IsEnd(); it = it.Next().Next())
+            ++count;
+        return count;
+    }
+
+    std::string_view JsonTapeNode::GetObjectKey(size_t index) const noexcept
+    {
+        assert(GetType() == JsonType::Object);
+        // 对象中 key 与值交替存放
+        JsonTapeNode it = First();
+        for (; index > 0; --index)
+            it = it.Next().Next();
+        assert(!it.IsEnd());
+        return it.GetString();
+    }
+
+    JsonTapeNode JsonTapeNode::GetObjectValue(size_t index) const noexcept
+    {
+        assert(GetType() == JsonType::Object);
+        JsonTapeNode it = First();
+        for (; index > 0; --index)
+            it = it.Next().Next();
+        assert(!it.IsEnd());
+        return it.Next();
+    }
+
+    long long JsonTapeNode::FindObjectIndex(std::string_view key) const noexcept
+    {
+        assert(GetType() == JsonType::Object);
+        long long index = 0;
+        for (JsonTapeNode it = First(); !it.IsEnd(); it = it.Next().Next(), ++index)
+        {
+            if (it.GetString() == key)
+                return index;
+        }
+        return -1;
+    }
+
+    JsonTapeNode JsonTapeNode::First() const noexcept
+    {
+        assert(GetType() == JsonType::Array || GetType() == JsonType::Object);
+        return JsonTapeNode(m_doc, m_index + 1);
+    }
+
+    JsonTapeNode JsonTapeNode::Next() const noexcept
+    {
+        uint64_t word = Word(m_index);
+        switch (word >> 56)
+        {
+        // 跳过整个数组或对象：直接跳到结束标记之后
+        case JsonTapeTag::ArrayStart:
+        case JsonTapeTag::ObjectStart:
+            return JsonTapeNode(m_doc, static_cast<size_t>(word & kTapeIndexMask) + 1);
+        case JsonTapeTag::Number:
+            return JsonTapeNode(m_doc, m_index + 2);
+        default:
+            assert(!IsEnd());
+            return JsonTapeNode(m_doc, m_index + 1);
+        }
+    }
+
+    bool JsonTapeNode::IsEnd() const noexcept
+    {
+        uint64_t tag = Word(m_index) >> 56;
+        return tag == JsonTapeTag::ArrayEnd || tag == JsonTapeTag::ObjectEnd;
+    }
+
+    Json JsonTapeNode::ToJson() const noexcept
+    {
+        Json ret;
+        switch (GetType())
+        {
+        case JsonType::True:
+            ret.SetBoolean(true);
+            break;
+        case JsonType::False:
+            ret.SetBoolean(false);
+            break;
+        case JsonType::Number:
+            ret.SetNumber(GetNumber());
+            break;
+        case JsonType::String:
+            ret.SetString(std::string(GetString()));
+            break;
+        case JsonType::Array:
+            ret.SetArray();
+            for (JsonTapeNode it = First(); !it.IsEnd(); it = it.Next())
+                ret.PushbackArrayElement(it.ToJson());
+            break;
+        case JsonType::Object:
+            ret.SetObject();
+            for (JsonTapeNode it = First(); !it.IsEnd(); it = it.Next().Next())
+                ret.EmplaceObjectValue(std::string(it.GetString()), it.Next().ToJson());
+            break;
+        }
+        return ret;
+    }
+
+    void JsonTape::Parse(const std::string &content, std::string &status) noexcept
+    {
+        try
+        {
+            Parse(content);
+            status = "parse ok";
+        }
+        catch (const JsonException &msg)
+        {
+            status = msg.what();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void JsonTape::Parse(const std::string &content)
+    {
+        JsonTapeParser(m_tape, m_strings, content);
+    }
+
+    JsonTapeNode JsonTape::Root() const noexcept
+    {
+        assert(!m_tape.empty());
+        return JsonTapeNode(this, 0);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef JSONTAPE_H
+#define JSONTAPE_H
+#include "Json.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SJson
+{
+    class JsonTape;
+    /* 磁带中的一个值，只在所属的 JsonTape 没有被重新解析或销毁之前有效 */
+    class JsonTapeNode
+    {
+    public:
+        int GetType() const noexcept;
+        double GetNumber() const noexcept;
+        std::string_view GetString() const noexcept;
+        size_t GetArraySize() const noexcept;
+        /* 按下标访问需要从第一个元素开始跳过 index 个兄弟节点，顺序遍历请使用 First 与 Next */
+        JsonTapeNode GetArrayElement(size_t index) const noexcept;
+        size_t GetObjectSize() const noexcept;
+        std::string_view GetObjectKey(size_t index) const noexcept;
+        JsonTapeNode GetObjectValue(size_t index) const noexcept;
+        long long FindObjectIndex(std::string_view key) const noexcept;
+        /* 数组的第一个元素，或对象的第一个 key；容器为空时返回容器的结束位置，此时 IsEnd() 为 true */
+        JsonTapeNode First() const noexcept;
+        /* 下一个兄弟节点，借助容器开头记录的结束位置，跳过整个子树只需要 O(1) */
+        JsonTapeNode Next() const noexcept;
+        bool IsEnd() const noexcept;
+        /* 拷贝为可修改的 Json */
+        Json ToJson() const noexcept;
+
+    private:
+        friend class JsonTape;
+        JsonTapeNode(const JsonTape *doc, size_t index) noexcept : m_doc(doc), m_index(index) {}
+        uint64_t Word(size_t index) const noexcept;
+        const JsonTape *m_doc;
+        size_t m_index;
+    };
+
+    /*
+     * 只读的 json 文档：解析器把整个文档写成一条连续的磁带，而不是 JsonValue 树。
+     * 每个值占一个 64 位的字，高 8 位是类型标记，低 56 位是数据：
+     *   数字后面紧跟一个字保存 double；字符串保存在字符串缓冲区中的偏移；
+     *   数组与对象的开始标记保存结束标记的位置与元素个数，结束标记保存开始标记的位置。
+     */
+    class JsonTape final
+    {
+    public:
+        void Parse(const std::string &content, std::string &status) noexcept;
+        void Parse(const std::string &content);
+        JsonTapeNode Root() const noexcept;
+
+    private:
+        friend class JsonTapeNode;
+        std::vector<uint64_t> m_tape;
+        /* 字符串缓冲区：每个字符串是 4 字节长度、字符串本身以及结尾的 '\0' */
+        std::string m_strings;
+    };
+}
+#endif // JSONTAPE_H
@@ -0,0 +1,174 @@
+#include "JsonTapeParser.h"
+#include "JsonException.h"
+#include <cstring>
+namespace SJson
+{
+    JsonTapeParser::JsonTapeParser(std::vector<uint64_t> &tape, std::string &strings, const std::string &content)
+        : JsonScanner(content), m_tape(tape), m_strings(strings)
+    {
+        m_tape.clear();
+        m_strings.clear();
+        try
+        {
+            ParseWhitespace();
+            ParseValue();
+            ParseWhitespace();
+            if (*m_cur != '\0')
+                throw(JsonException("parse root not singular"));
+        }
+        catch (const JsonException &)
+        {
+            m_tape.clear();
+            m_strings.clear();
+            throw;
+        }
+    }
+
+    void JsonTapeParser::ParseValue()
+    {
+        switch (*m_cur)
+        {
+        case 'n':
+            ParseLiteralRaw("null");
+            Emit(JsonTapeTag::Null, 0);
+            return;
+        case 't':
+            ParseLiteralRaw("true");
+            Emit(JsonTapeTag::True, 0);
+            return;
+        case 'f':
+            ParseLiteralRaw("false");
+            Emit(JsonTapeTag::False, 0);
+            return;
+        case '\"':
+            ParseString();
+            return;
+        case '[':
+            ParseArray();
+            return;
+        case '{':
+            ParseObject();
+            return;
+        case '\0':
+            throw(JsonException("parse expect value"));
+        default:
+        {
+            // 数字占两个字：标记与 double 的二进制
+            double d = ParseNumberRaw();
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            Emit(JsonTapeTag::Number, 0);
+            m_tape.push_back(bits);
+            return;
+        }
+        }
+    }
+
+    void JsonTapeParser::ParseString()
+    {
+        m_tmp.clear();
+        ParseStringRaw(m_tmp);
+        uint32_t size = static_cast<uint32_t>(m_tmp.size());
+        Emit(JsonTapeTag::String, m_strings.size());
+        m_strings.append(reinterpret_cast<const char *>(&size), sizeof(size));
+        m_strings += m_tmp;
+        m_strings += '\0';
+    }
+
+    void JsonTapeParser::ParseArray()
+    {
+        Expect('[');
+        ParseWhitespace();
+        size_t start = Emit(JsonTapeTag::ArrayStart, 0);
+        uint64_t count = 0;
+        if (*m_cur == ']')
+        {
+            ++m_cur;
+            Close(start, JsonTapeTag::ArrayEnd, count);
+            return;
+        }
+        for (;;)
+        {
+            ParseValue();
+            ++count;
+            ParseWhitespace();
+            if (*m_cur == ',')
+            {
+                ++m_cur;
+                ParseWhitespace();
+            }
+            else if (*m_cur == ']')
+            {
+                ++m_cur;
+                Close(start, JsonTapeTag::ArrayEnd, count);
+                return;
+            }
+            else
+                throw(JsonException("parse miss comma or square bracket"));
+        }
+    }
+
+    void JsonTapeParser::ParseObject()
+    {
+        Expect('{');
+        ParseWhitespace();
+        size_t start = Emit(JsonTapeTag::ObjectStart, 0);
+        uint64_t count = 0;
+        if (*m_cur == '}')
+        {
+            ++m_cur;
+            Close(start, JsonTapeTag::ObjectEnd, count);
+            return;
+        }
+        for (;;)
+        {
+            // key 与值依次写入磁带
+            if (*m_cur != '\"')
+                throw(JsonException("parse miss key"));
+            try
+            {
+                ParseString();
+            }
+            catch (const JsonException &)
+            {
+                throw(JsonException("parse miss key"));
+            }
+            ParseWhitespace();
+            if (*m_cur++ != ':')
+                throw(JsonException("parse miss colon"));
+            ParseWhitespace();
+            ParseValue();
+            ++count;
+            ParseWhitespace();
+            if (*m_cur == ',')
+            {
+                ++m_cur;
+                ParseWhitespace();
+            }
+            else if (*m_cur == '}')
+            {
+                ++m_cur;
+                Close(start, JsonTapeTag::ObjectEnd, count);
+                return;
+            }
+            else
+                throw(JsonException("parse miss comma or curly bracket"));
+        }
+    }
+
+    size_t JsonTapeParser::Emit(JsonTapeTag::type tag, uint64_t payload)
+    {
+        m_tape.push_back((static_cast<uint64_t>(tag) << 56) | payload);
+        return m_tape.size() - 1;
+    }
+
+    void JsonTapeParser::Close(size_t start, JsonTapeTag::type tag, uint64_t count)
+    {
+        size_t end = Emit(tag, start);
+        if (end > kTapeIndexMask)
+            throw(JsonException("parse document too large"));
+        if (count > kTapeCountMax)
+            count = kTapeCountMax;
+        m_tape[start] |= (count << 32) | end;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef JSONTAPEPARSER_H
+#define JSONTAPEPARSER_H
+#include "JsonScanner.h"
+#include <cstdint>
+#include <vector>
+
+namespace SJson
+{
+    namespace JsonTapeTag
+    {
+        enum type : unsigned char
+        {
+            Null = 'n',
+            True = 't',
+            False = 'f',
+            Number = 'd',
+            String = '"',
+            ArrayStart = '[',
+            ArrayEnd = ']',
+            ObjectStart = '{',
+            ObjectEnd = '}'
+        };
+    }
+    /* 容器开始标记的数据：低 32 位是结束标记的位置，再往上 24 位是元素个数，个数溢出时需要遍历得到 */
+    const uint64_t kTapeIndexMask = 0xFFFFFFFF;
+    const uint64_t kTapeCountMax = 0xFFFFFF;
+
+    /* 把 json 文本解析为磁带 */
+    class JsonTapeParser : private JsonScanner
+    {
+    public:
+        JsonTapeParser(std::vector<uint64_t> &tape, std::string &strings, const std::string &content);
+
+    private:
+        void ParseValue();
+        void ParseString();
+        void ParseArray();
+        void ParseObject();
+        /* 写入一个字，返回它在磁带中的位置 */
+        size_t Emit(JsonTapeTag::type tag, uint64_t payload);
+        /* 容器结束时回填开始标记中的结束位置与元素个数 */
+        void Close(size_t start, JsonTapeTag::type tag, uint64_t count);
+        std::vector<uint64_t> &m_tape;
+        std::string &m_strings;
+        /* 复用的字符串解析缓冲区 */
+        std::string m_tmp;
+    };
+}
+#endif // JSONTAPEPARSER_H
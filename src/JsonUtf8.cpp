@@ -0,0 +1,45 @@
+#include "JsonUtf8.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SJSON_SSE2
+#endif
+namespace SJson
+{
+    size_t ScanStringRun(const char *p, const char *end, char quote) noexcept
+    {
+        const char *start = p;
+#ifdef SJSON_SSE2
+        const __m128i quotes = _mm_set1_epi8(quote);
+        const __m128i backslashes = _mm_set1_epi8('\\');
+        const __m128i space = _mm_set1_epi8(0x20);
+        while (end - p >= 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            // 有符号比较时非 ASCII 字节是负数，和控制字符一样小于 0x20，一次比较就能找出两者
+            __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, backslashes)),
+                                           _mm_cmplt_epi8(chunk, space));
+            int mask = _mm_movemask_epi8(special);
+            if (mask != 0)
+            {
+                // 第一个需要特殊处理的字节的位置
+                int offset = 0;
+                while (!(mask & 1))
+                {
+                    mask >>= 1;
+                    ++offset;
+                }
+                return p + offset - start;
+            }
+            p += 16;
+        }
+#endif
+        while (p < end)
+        {
+            unsigned char ch = static_cast<unsigned char>(*p);
+            if (ch == static_cast<unsigned char>(quote) || ch == '\\' || ch < 0x20 || ch >= 0x80)
+                break;
+            ++p;
+        }
+        return p - start;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef JSONUTF8_H
+#define JSONUTF8_H
+#include <cstddef>
+namespace SJson
+{
+    /*
+     * 检查 p 开始的非 ASCII 字符是否是合法的 UTF-8 编码（RFC 3629），返回编码的字节数，不合法时返回 0。
+     * 拒绝过长编码、代理区码点（U+D800 ~ U+DFFF）以及大于 U+10FFFF 的码点。
+     */
+    inline size_t Utf8SequenceLength(const unsigned char *p, const unsigned char *end) noexcept
+    {
+        unsigned char c = p[0];
+        size_t len;
+        // 第二个字节的合法范围取决于第一个字节，用来排除过长编码、代理区与超出范围的码点
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF)
+            len = 2;
+        else if (c >= 0xE0 && c <= 0xEF)
+        {
+            len = 3;
+            if (c == 0xE0)
+                lo = 0xA0;
+            else if (c == 0xED)
+                hi = 0x9F;
+        }
+        else if (c >= 0xF0 && c <= 0xF4)
+        {
+            len = 4;
+            if (c == 0xF0)
+                lo = 0x90;
+            else if (c == 0xF4)
+                hi = 0x8F;
+        }
+        else
+            return 0;
+        if (static_cast<size_t>(end - p) < len || p[1] < lo || p[1] > hi)
+            return 0;
+        for (size_t i = 2; i < len; ++i)
+        {
+            if ((p[i] & 0xC0) != 0x80)
+                return 0;
+        }
+        return len;
+    }
+
+    /*
+     * 返回从 p 开始、字符串中可以原样保留的字节数：不是 quote、反斜杠、控制字符，也不是非 ASCII 字节。
+     * 支持 SSE2 时每次检查 16 个字节，ASCII 为主的字符串几乎不需要逐个字节处理。
+     */
+    size_t ScanStringRun(const char *p, const char *end, char quote) noexcept;
+}
+#endif // JSONUTF8_H
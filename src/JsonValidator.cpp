@@ -0,0 +1,256 @@
+#include "JsonValidator.h"
+#include "JsonException.h"
+#include "JsonUtf8.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+namespace SJson
+{
+    static bool IsDigit(char ch) noexcept
+    {
+        return ch >= '0' && ch <= '9';
+    }
+
+    JsonValidator::JsonValidator(const char *data, size_t size) : m_cur(data), m_end(data + size)
+    {
+        SkipWhitespace();
+        ValidateValue();
+        SkipWhitespace();
+        if (m_cur != m_end)
+            throw(JsonException("parse root not singular"));
+    }
+
+    void JsonValidator::ValidateValue()
+    {
+        for (;;)
+        {
+            // 1、检查一个值；空数组和空对象直接结束，否则进入容器，回到循环开头检查第一个元素
+            switch (Peek())
+            {
+            case 'n':
+                ValidateLiteral("null", 4);
+                break;
+            case 't':
+                ValidateLiteral("true", 4);
+                break;
+            case 'f':
+                ValidateLiteral("false", 5);
+                break;
+            case '\"':
+                ValidateString();
+                break;
+            case '[':
+                ++m_cur;
+                SkipWhitespace();
+                if (Peek() == ']')
+                {
+                    ++m_cur;
+                    break;
+                }
+                m_stack += '[';
+                continue;
+            case '{':
+                ++m_cur;
+                SkipWhitespace();
+                if (Peek() == '}')
+                {
+                    ++m_cur;
+                    break;
+                }
+                m_stack += '{';
+                ValidateKey();
+                continue;
+            case '\0':
+                throw(JsonException("parse expect value"));
+            default:
+                ValidateNumber();
+                break;
+            }
+
+            // 2、一个值结束之后：遇到逗号时检查下一个元素，遇到右括号时结束所在的容器，直到回到最外层
+            for (;;)
+            {
+                if (m_stack.empty())
+                    return;
+                SkipWhitespace();
+                const char open = m_stack.back();
+                const char ch = Peek();
+                if (ch == ',')
+                {
+                    ++m_cur;
+                    SkipWhitespace();
+                    if (open == '{')
+                        ValidateKey();
+                    break;
+                }
+                if ((open == '[' && ch == ']') || (open == '{' && ch == '}'))
+                {
+                    ++m_cur;
+                    m_stack.pop_back();
+                    continue;
+                }
+                throw(JsonException(open == '[' ? "parse miss comma or square bracket" : "parse miss comma or curly bracket"));
+            }
+        }
+    }
+
+    void JsonValidator::ValidateKey()
+    {
+        if (Peek() != '\"')
+            throw(JsonException("parse miss key"));
+        try
+        {
+            ValidateString();
+        }
+        catch (const JsonException &)
+        {
+            throw(JsonException("parse miss key"));
+        }
+        SkipWhitespace();
+        if (Peek() != ':')
+            throw(JsonException("parse miss colon"));
+        ++m_cur;
+        SkipWhitespace();
+    }
+
+    void JsonValidator::ValidateLiteral(const char *literal, size_t len)
+    {
+        if (static_cast<size_t>(m_end - m_cur) < len || memcmp(m_cur, literal, len) != 0)
+            throw(JsonException("parse invalid value"));
+        m_cur += len;
+    }
+
+    void JsonValidator::ValidateNumber()
+    {
+        const char *start = m_cur;
+        if (Peek() == '-')
+            ++m_cur;
+        // 整数部分：单个 0，或者 1~9 开头的任意个数字
+        if (Peek() == '0')
+            ++m_cur;
+        else
+        {
+            if (!IsDigit(Peek()))
+                throw(JsonException("parse invalid value"));
+            while (IsDigit(Peek()))
+                ++m_cur;
+        }
+        const size_t intDigits = m_cur - start;
+        if (Peek() == '.')
+        {
+            ++m_cur;
+            if (!IsDigit(Peek()))
+                throw(JsonException("parse invalid value"));
+            while (IsDigit(Peek()))
+                ++m_cur;
+        }
+        bool exponent = false;
+        if (Peek() == 'e' || Peek() == 'E')
+        {
+            exponent = true;
+            ++m_cur;
+            if (Peek() == '+' || Peek() == '-')
+                ++m_cur;
+            if (!IsDigit(Peek()))
+                throw(JsonException("parse invalid value"));
+            while (IsDigit(Peek()))
+                ++m_cur;
+        }
+        // 与解析器一样拒绝超出 double 范围的数字；只有带指数或者整数部分很长的数字才可能超出，这时才转换
+        if (exponent || intDigits > 308)
+        {
+            std::string text(start, m_cur);
+            errno = 0;
+            double v = strtod(text.c_str(), nullptr);
+            if (errno == ERANGE && (v == HUGE_VAL || v == -HUGE_VAL))
+                throw(JsonException("parse number too big"));
+        }
+    }
+
+    void JsonValidator::ValidateString()
+    {
+        ++m_cur; // 跳过开头的引号
+        for (;;)
+        {
+            // 跳过不需要处理的连续字节
+            m_cur += ScanStringRun(m_cur, m_end, '\"');
+            if (m_cur == m_end)
+                throw(JsonException("parse miss quotation mark"));
+            const unsigned char ch = static_cast<unsigned char>(*m_cur);
+            if (ch == '\"')
+            {
+                ++m_cur;
+                return;
+            }
+            if (ch == '\\')
+            {
+                ++m_cur;
+                unsigned u;
+                switch (Peek())
+                {
+                case '\"':
+                case '\\':
+                case '/':
+                case 'b':
+                case 'f':
+                case 'n':
+                case 'r':
+                case 't':
+                    ++m_cur;
+                    break;
+                case 'u':
+                    ++m_cur;
+                    ValidateHex4(u);
+                    // 高代理项后面必须紧跟一个低代理项
+                    if (u >= 0xD800 && u <= 0xDBFF)
+                    {
+                        if (m_end - m_cur < 2 || m_cur[0] != '\\' || m_cur[1] != 'u')
+                            throw(JsonException("parse invalid unicode surrogate"));
+                        m_cur += 2;
+                        ValidateHex4(u);
+                        if (u < 0xDC00 || u > 0xDFFF)
+                            throw(JsonException("parse invalid unicode surrogate"));
+                    }
+                    break;
+                default:
+                    throw(JsonException("parse invalid string escape"));
+                }
+            }
+            else if (ch < 0x20)
+                throw(JsonException("parse invalid string char"));
+            else
+            {
+                size_t len = Utf8SequenceLength(reinterpret_cast<const unsigned char *>(m_cur), reinterpret_cast<const unsigned char *>(m_end));
+                if (len == 0)
+                    throw(JsonException("parse invalid utf8"));
+                m_cur += len;
+            }
+        }
+    }
+
+    void JsonValidator::ValidateHex4(unsigned &u)
+    {
+        u = 0;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const char ch = Peek();
+            u <<= 4;
+            if (IsDigit(ch))
+                u |= ch - '0';
+            else if (ch >= 'A' && ch <= 'F')
+                u |= ch - ('A' - 10);
+            else if (ch >= 'a' && ch <= 'f')
+                u |= ch - ('a' - 10);
+            else
+                throw(JsonException("parse invalid unicode hex"));
+            ++m_cur;
+        }
+    }
+
+    void JsonValidator::SkipWhitespace() noexcept
+    {
+        while (m_cur < m_end && (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r'))
+            ++m_cur;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef JSONVALIDATOR_H
+#define JSONVALIDATOR_H
+#include <cstddef>
+#include <string>
+namespace SJson
+{
+    /*
+     * 只检查 json 文本是否合法，不建立任何 JsonValue：RFC 8259 语法、字符串转义与 UTF-8 编码。
+     * 输入由长度确定，不需要以 '\0' 结尾；嵌套用一个字符栈记录而不是递归，再深的嵌套也不会栈溢出。
+     * 不合法时抛出与 JsonParser 相同的 JsonException，字符串不是合法的 UTF-8 时为 "parse invalid utf8"。
+     */
+    class JsonValidator
+    {
+    public:
+        JsonValidator(const char *data, size_t size);
+
+    private:
+        void ValidateValue();
+        /* 对象的 key 以及后面的冒号 */
+        void ValidateKey();
+        void ValidateLiteral(const char *literal, size_t len);
+        void ValidateNumber();
+        void ValidateString();
+        void ValidateHex4(unsigned &u);
+        void SkipWhitespace() noexcept;
+        /* 当前字符，到达结尾时返回 '\0' */
+        char Peek() const noexcept { return m_cur < m_end ? *m_cur : '\0'; }
+        const char *m_cur;
+        const char *m_end;
+        /* 还没有结束的数组和对象，保存 '[' 或 '{' */
+        std::string m_stack;
+    };
+}
+#endif // JSONVALIDATOR_H
@@ -1,17 +1,42 @@
 #include <assert.h>
+#include <stdlib.h>
 #include <string>
 #include "JsonValue.h"
+#include "JsonShape.h"
 #include "JsonParser.h"
 #include "JsonGenerator.h"
+#include "JsonCborDecoder.h"
+#include "JsonCborEncoder.h"
+#include "JsonMsgPackDecoder.h"
+#include "JsonMsgPackEncoder.h"
+#include "JsonSnapshotWriter.h"
+#include "JsonPatcher.h"
+#include "JsonDiffer.h"
+#include "JsonColumnExtractor.h"
+#include "JsonAggregator.h"
 namespace SJson
 {
+    /* 对象的 key 个数达到这个值时才建立哈希表 */
+    static const size_t kKeyIndexThreshold = 8;
+
     JsonValue &JsonValue::operator=(const JsonValue &rhs) noexcept
     {
+        if (this == &rhs)
+            return *this;
         Free();
         Init(rhs);
         return *this;
     }
 
+    JsonValue &JsonValue::operator=(JsonValue &&rhs) noexcept
+    {
+        if (this == &rhs)
+            return *this;
+        Free();
+        Init(std::move(rhs));
+        return *this;
+    }
+
     JsonValue::~JsonValue() noexcept
     {
         Free();
@@ -25,37 +50,98 @@ namespace SJson
     void JsonValue::SetType(JsonType::type t)
     {
         // 先释放内存，然后再重置类型
+        Invalidate();
         Free();
         m_type = t;
     }
 
-    void JsonValue::Parse(const std::string &content)
+    void JsonValue::Parse(const std::string &content, int flags)
     {
-        JsonParser(*this, content);
+        // 相同的 key 在文档内只保存一份，表在解析结束后释放
+        JsonKeyTable keys;
+        JsonParser(*this, content, keys, flags);
+    }
+
+    void JsonValue::Parse(const std::string &content, JsonKeyTable &keys, int flags)
+    {
+        JsonParser(*this, content, keys, flags);
+    }
+
+    void JsonValue::ParseCbor(const std::string &content)
+    {
+        JsonCborDecoder(*this, content);
+    }
+
+    void JsonValue::ParseMsgPack(const std::string &content, int flags)
+    {
+        JsonMsgPackDecoder(*this, content, flags);
     }
 
     double JsonValue::GetNumber() const noexcept
     {
         assert(m_type == JsonType::Number);
+        if (m_numText)
+            return strtod(m_string.c_str(), nullptr);
         return m_num;
     }
 
     void JsonValue::SetNumber(double d) noexcept
     {
+        Invalidate();
         Free();
         m_type = JsonType::Number;
         m_num = d;
     }
 
-    const std::string &JsonValue::GetString() const noexcept
+    void JsonValue::SetNumberText(std::string &&text) noexcept
+    {
+        Invalidate();
+        Free();
+        m_type = JsonType::Number;
+        m_numText = true;
+        new (&m_string) std::string(std::move(text));
+    }
+
+    std::string_view JsonValue::GetNumberText() const noexcept
+    {
+        assert(m_type == JsonType::Number);
+        if (m_numText)
+            return m_string;
+        return std::string_view();
+    }
+
+    std::string_view JsonValue::GetString() const noexcept
     {
         assert(m_type == JsonType::String);
+        if (m_escaped)
+            return DecodedString();
+        if (m_borrowed)
+            return std::string_view(m_view.data, m_view.size);
         return m_string;
     }
 
+    std::string_view JsonValue::DecodedString() const noexcept
+    {
+        auto cache = LoadCache();
+        for (;;)
+        {
+            if (cache && cache->decoded)
+                return *cache->decoded;
+            auto decoded = std::make_shared<std::string>();
+            JsonStringDecoder(m_view.data, m_view.size, *decoded);
+            JsonValueCache next = cache ? *cache : JsonValueCache();
+            next.decoded = std::move(decoded);
+            // 其他线程返回的 string_view 可能指向已经保存的结果，所以只在缓存没有变化时保存，否则使用已经保存的结果
+            std::shared_ptr<const JsonValueCache> created = std::make_shared<JsonValueCache>(std::move(next));
+            if (std::atomic_compare_exchange_strong(&m_cache, &cache, created))
+                return *created->decoded;
+        }
+    }
+
     void JsonValue::SetString(const std::string &str) noexcept
     {
-        if (m_type == JsonType::String)
+        Invalidate();
+        if (m_type == JsonType::String && !m_borrowed)
             m_string = str;
         else
         {
@@ -66,199 +152,888 @@ namespace SJson
         }
     }
 
+    void JsonValue::SetString(std::string &&str) noexcept
+    {
+        Invalidate();
+        if (m_type == JsonType::String && !m_borrowed)
+            m_string = std::move(str);
+        else
+        {
+            Free();
+            m_type = JsonType::String;
+            new (&m_string) std::string(std::move(str));
+        }
+    }
+
+    void JsonValue::SetStringView(const char *data, size_t size) noexcept
+    {
+        Invalidate();
+        Free();
+        m_type = JsonType::String;
+        m_borrowed = true;
+        m_view.data = data;
+        m_view.size = size;
+    }
+
+    void JsonValue::SetEscapedStringView(const char *data, size_t size) noexcept
+    {
+        SetStringView(data, size);
+        m_escaped = true;
+    }
+
+    std::string_view JsonValue::GetEscapedString() const noexcept
+    {
+        assert(m_type == JsonType::String);
+        if (m_escaped)
+            return std::string_view(m_view.data, m_view.size);
+        return std::string_view();
+    }
+
+    const std::string &JsonValue::GetRaw() const noexcept
+    {
+        assert(m_type == JsonType::Raw);
+        return m_string;
+    }
+
+    void JsonValue::SetRaw(const std::string &content) noexcept
+    {
+        SetRaw(std::string(content));
+    }
+
+    void JsonValue::SetRaw(std::string &&content) noexcept
+    {
+        Invalidate();
+        if (m_type == JsonType::Raw)
+            m_string = std::move(content);
+        else
+        {
+            Free();
+            m_type = JsonType::Raw;
+            new (&m_string) std::string(std::move(content));
+        }
+    }
+
+    JsonValue JsonValue::ParseRaw() const noexcept
+    {
+        assert(m_type == JsonType::Raw);
+        JsonValue val;
+        try
+        {
+            val.Parse(m_string, ParseFlag::Default);
+        }
+        catch (...)
+        {
+            val.SetType(JsonType::Null);
+        }
+        return val;
+    }
+
     size_t JsonValue::GetArraySize() const noexcept
     {
         assert(m_type == JsonType::Array);
-        return m_array.size();
+        return m_array->packed ? m_array->numbers.size() : m_array->values.size();
     }
 
     const JsonValue &JsonValue::GetArrayElement(size_t index) const noexcept
     {
         assert(m_type == JsonType::Array);
-        assert(index >= 0 && index < m_array.size());
-        return m_array[index];
+        assert(index >= 0 && index < GetArraySize());
+        if (m_array->packed)
+            return BoxedArray()[index];
+        return m_array->values[index];
+    }
+
+    JsonValue &JsonValue::MutableArrayElement(size_t index) noexcept
+    {
+        assert(m_type == JsonType::Array);
+        assert(index < GetArraySize());
+        Invalidate();
+        // 元素可能被改为其他类型，不能再保持 packed
+        return DetachArrayValues()[index];
     }
 
     void JsonValue::SetArray(const std::vector<JsonValue> &arr) noexcept
     {
-        if (m_type == JsonType::Array)
-            m_array = arr;
+        // 先建立新的存储再释放旧的，参数可能引用了当前值内部的数据
+        auto storage = std::make_shared<ArrayStorage>();
+        storage->values = arr;
+        Invalidate();
+        Free();
+        m_type = JsonType::Array;
+        new (&m_array) ArrayPtr(std::move(storage));
+    }
+
+    void JsonValue::SetArray(std::vector<JsonValue> &&arr) noexcept
+    {
+        // 先建立新的存储再释放旧的，参数可能引用了当前值内部的数据
+        auto storage = std::make_shared<ArrayStorage>();
+        storage->values = std::move(arr);
+        Invalidate();
+        Free();
+        m_type = JsonType::Array;
+        new (&m_array) ArrayPtr(std::move(storage));
+    }
+
+    void JsonValue::SetArray(std::vector<double> &&numbers) noexcept
+    {
+        auto storage = std::make_shared<ArrayStorage>();
+        storage->numbers = std::move(numbers);
+        storage->packed = true;
+        Invalidate();
+        Free();
+        m_type = JsonType::Array;
+        new (&m_array) ArrayPtr(std::move(storage));
+    }
+
+    const double *JsonValue::GetArrayNumbers() const noexcept
+    {
+        assert(m_type == JsonType::Array);
+        return m_array->packed ? m_array->numbers.data() : nullptr;
+    }
+
+    void JsonValue::ReserveArray(size_t capacity) noexcept
+    {
+        assert(m_type == JsonType::Array);
+        auto &arr = DetachArray();
+        if (arr.packed)
+            arr.numbers.reserve(capacity);
         else
+            arr.values.reserve(capacity);
+    }
+
+    void JsonValue::PushbackArrayElement(const JsonValue &val) noexcept
+    {
+        assert(m_type == JsonType::Array);
+        // 插入自身时先拷贝一份，拷贝持有原来的存储，分离之后数组不会引用自己的存储而形成环
+        if (val.m_type == JsonType::Array && val.m_array == m_array)
+            return PushbackArrayElement(JsonValue(val));
+        Invalidate();
+        // 数字直接追加到 packed 数组中，保存原文的数字除外；val 可能引用了本数组的元素，先取出数字
+        if (val.m_type == JsonType::Number && !val.m_numText && m_array->packed)
         {
-            Free();
-            m_type = JsonType::Array;
-            new (&m_array) std::vector<JsonValue>(arr);
+            double d = val.m_num;
+            DetachArray().numbers.push_back(d);
+            return;
         }
+        DetachArrayValues().push_back(val);
     }
 
-    void JsonValue::PushbackArrayElement(const JsonValue &val) noexcept
+    void JsonValue::PushbackArrayElement(JsonValue &&val) noexcept
     {
         assert(m_type == JsonType::Array);
-        m_array.push_back(val);
+        Invalidate();
+        if (val.m_type == JsonType::Number && !val.m_numText && m_array->packed)
+        {
+            double d = val.m_num;
+            DetachArray().numbers.push_back(d);
+            return;
+        }
+        DetachArrayValues().push_back(std::move(val));
     }
 
     void JsonValue::PopbackArrayElement() noexcept
     {
         assert(m_type == JsonType::Array);
-        m_array.pop_back();
+        Invalidate();
+        auto &arr = DetachArray();
+        if (arr.packed)
+            arr.numbers.pop_back();
+        else
+            arr.values.pop_back();
     }
 
     void JsonValue::EraseArrayElement(size_t index, size_t count) noexcept
     {
         assert(m_type == JsonType::Array);
-        m_array.erase(m_array.begin() + index, m_array.begin() + index + count);
+        Invalidate();
+        auto &arr = DetachArray();
+        if (arr.packed)
+            arr.numbers.erase(arr.numbers.begin() + index, arr.numbers.begin() + index + count);
+        else
+            arr.values.erase(arr.values.begin() + index, arr.values.begin() + index + count);
     }
 
     void JsonValue::InsertArrayElement(const JsonValue &val, size_t index) noexcept
     {
         assert(m_type == JsonType::Array);
-        m_array.insert(m_array.begin() + index, val);
+        if (val.m_type == JsonType::Array && val.m_array == m_array)
+            return InsertArrayElement(JsonValue(val), index);
+        Invalidate();
+        if (val.m_type == JsonType::Number && !val.m_numText && m_array->packed)
+        {
+            double d = val.m_num;
+            auto &numbers = DetachArray().numbers;
+            numbers.insert(numbers.begin() + index, d);
+            return;
+        }
+        auto &arr = DetachArrayValues();
+        arr.insert(arr.begin() + index, val);
+    }
+
+    void JsonValue::InsertArrayElement(JsonValue &&val, size_t index) noexcept
+    {
+        assert(m_type == JsonType::Array);
+        Invalidate();
+        if (val.m_type == JsonType::Number && !val.m_numText && m_array->packed)
+        {
+            double d = val.m_num;
+            auto &numbers = DetachArray().numbers;
+            numbers.insert(numbers.begin() + index, d);
+            return;
+        }
+        auto &arr = DetachArrayValues();
+        arr.insert(arr.begin() + index, std::move(val));
     }
 
     void JsonValue::ClearArray() noexcept
     {
         assert(m_type == JsonType::Array);
-        m_array.clear();
+        Invalidate();
+        auto &arr = DetachArray();
+        arr.numbers.clear();
+        arr.values.clear();
     }
 
-    void JsonValue::SetObject(const std::vector<std::pair<std::string, JsonValue>> &obj) noexcept
+    /* 所有空对象共享的 shape，被共享所以不会被修改 */
+    static const std::shared_ptr<JsonShape> &EmptyShape() noexcept
     {
-        if (m_type == JsonType::Object)
-            m_object = obj;
-        else
+        static const std::shared_ptr<JsonShape> empty = std::make_shared<JsonShape>();
+        return empty;
+    }
+
+    void JsonValue::SetObject(const std::vector<std::pair<JsonKey, JsonValue>> &obj) noexcept
+    {
+        // 先建立新的存储再释放旧的，参数可能引用了当前值内部的数据
+        auto storage = std::make_shared<ObjectStorage>();
+        storage->shape = obj.empty() ? EmptyShape() : std::make_shared<JsonShape>();
+        storage->shape->keys.reserve(obj.size());
+        storage->values.reserve(obj.size());
+        for (auto &member : obj)
         {
-            Free();
-            m_type = JsonType::Object;
-            new (&m_object) std::vector<std::pair<std::string, JsonValue>>(obj);
+            storage->shape->keys.push_back(member.first);
+            storage->values.push_back(member.second);
+        }
+        Invalidate();
+        Free();
+        m_type = JsonType::Object;
+        new (&m_object) ObjectPtr(std::move(storage));
+    }
+
+    void JsonValue::SetObject(std::vector<std::pair<JsonKey, JsonValue>> &&obj) noexcept
+    {
+        // 先建立新的存储再释放旧的，参数可能引用了当前值内部的数据
+        auto storage = std::make_shared<ObjectStorage>();
+        storage->shape = obj.empty() ? EmptyShape() : std::make_shared<JsonShape>();
+        storage->shape->keys.reserve(obj.size());
+        storage->values.reserve(obj.size());
+        for (auto &member : obj)
+        {
+            storage->shape->keys.push_back(std::move(member.first));
+            storage->values.push_back(std::move(member.second));
         }
+        Invalidate();
+        Free();
+        m_type = JsonType::Object;
+        new (&m_object) ObjectPtr(std::move(storage));
+    }
+
+    void JsonValue::SetObject(std::shared_ptr<JsonShape> shape, std::vector<JsonValue> &&values) noexcept
+    {
+        assert(shape->keys.size() == values.size());
+        auto storage = std::make_shared<ObjectStorage>();
+        storage->shape = std::move(shape);
+        storage->values = std::move(values);
+        Invalidate();
+        Free();
+        m_type = JsonType::Object;
+        new (&m_object) ObjectPtr(std::move(storage));
+    }
+
+    void JsonValue::ReserveObject(size_t capacity) noexcept
+    {
+        assert(m_type == JsonType::Object);
+        DetachObject().values.reserve(capacity);
+        DetachShape().keys.reserve(capacity);
     }
 
     size_t JsonValue::GetObjectSize() const noexcept
     {
         assert(m_type == JsonType::Object);
-        return m_object.size();
+        return m_object->values.size();
     }
 
     const std::string &JsonValue::GetObjectKey(size_t index) const noexcept
     {
         assert(m_type == JsonType::Object);
-        assert(index >= 0 && index < m_object.size());
-        return m_object[index].first;
+        assert(index >= 0 && index < m_object->values.size());
+        return m_object->shape->keys[index].GetString();
     }
 
     const JsonValue &JsonValue::GetObjectValue(size_t index) const noexcept
     {
         assert(m_type == JsonType::Object);
-        assert(index >= 0 && index < m_object.size());
-        return m_object[index].second;
+        assert(index >= 0 && index < m_object->values.size());
+        return m_object->values[index];
+    }
+
+    JsonValue &JsonValue::MutableObjectValue(size_t index) noexcept
+    {
+        assert(m_type == JsonType::Object);
+        assert(index < m_object->values.size());
+        Invalidate();
+        return DetachObject().values[index];
     }
 
     size_t JsonValue::GetObjectKeyLength(size_t index) const noexcept
     {
         assert(m_type == JsonType::Object);
-        return m_object[index].first.size();
+        return m_object->shape->keys[index].GetString().size();
     }
 
     long long JsonValue::FindObjectIndex(const std::string &key) const noexcept
     {
         assert(m_type == JsonType::Object);
-        for (size_t i = 0, n = m_object.size(); i < n; ++i)
+        // key 较少时用不到哈希值，省去计算
+        return FindObjectIndex(key, m_object->values.size() < kKeyIndexThreshold ? 0 : HashKey(key));
+    }
+
+    long long JsonValue::FindObjectIndex(std::string_view key, size_t hash) const noexcept
+    {
+        assert(m_type == JsonType::Object);
+        // key 较少时线性查找比哈希表更快
+        if (m_object->values.size() < kKeyIndexThreshold)
+            return ScanObjectIndex(key);
+        auto index = GetKeyIndex();
+        const auto &keys = m_object->shape->keys;
+        const size_t mask = index->size() - 1;
+        // 线性探测，重复的 key 中先插入的在探测序列的前面，所以和线性查找一样返回第一个
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask)
+        {
+            uint32_t slot = (*index)[pos];
+            if (slot == 0)
+                return -1;
+            // intern 过的 key 指向同一份字符串，比较指针就能确定相等
+            if (keys[slot - 1].Equals(key))
+                return slot - 1;
+        }
+    }
+
+    const JsonShape *JsonValue::GetObjectShape() const noexcept
+    {
+        assert(m_type == JsonType::Object);
+        return m_object->shape.get();
+    }
+
+    long long JsonValue::ScanObjectIndex(std::string_view key) const noexcept
+    {
+        const auto &keys = m_object->shape->keys;
+        for (size_t i = 0, n = keys.size(); i < n; ++i)
         {
-            if (m_object[i].first == key)
+            if (keys[i].Equals(key))
                 return i;
         }
         return -1;
     }
 
+    size_t JsonValue::HashKey(std::string_view key) noexcept
+    {
+        return std::hash<std::string_view>()(key);
+    }
+
     void JsonValue::SetObjectValue(const std::string &key, const JsonValue &val) noexcept
     {
         assert(m_type == JsonType::Object);
-        auto index = FindObjectIndex(key);
+        // 与 PushbackArrayElement 相同，插入自身时先拷贝，避免对象引用自己的存储
+        if (val.m_type == JsonType::Object && val.m_object == m_object)
+            return SetObjectValue(key, JsonValue(val));
+        Invalidate();
+        // 已经建立了哈希表时直接使用；新增 key 会让哈希表失效，为一次查找建立哈希表不划算，所以没有时线性查找
+        auto index = std::atomic_load(&m_object->shape->keyIndex) ? FindObjectIndex(key) : ScanObjectIndex(key);
         if (index >= 0)
-            m_object[index].second = val;
+            DetachObject().values[index] = val;
         else
-            m_object.push_back(std::make_pair(key, val));
+        {
+            DetachObject().values.push_back(val);
+            DetachShape().keys.emplace_back(key);
+        }
+    }
+
+    void JsonValue::SetObjectValue(const std::string &key, JsonValue &&val) noexcept
+    {
+        assert(m_type == JsonType::Object);
+        Invalidate();
+        auto index = std::atomic_load(&m_object->shape->keyIndex) ? FindObjectIndex(key) : ScanObjectIndex(key);
+        if (index >= 0)
+            DetachObject().values[index] = std::move(val);
+        else
+        {
+            DetachObject().values.push_back(std::move(val));
+            DetachShape().keys.emplace_back(key);
+        }
+    }
+
+    void JsonValue::EmplaceObjectValue(std::string &&key, JsonValue &&val) noexcept
+    {
+        assert(m_type == JsonType::Object);
+        Invalidate();
+        DetachObject().values.push_back(std::move(val));
+        DetachShape().keys.emplace_back(std::move(key));
+    }
+
+    void JsonValue::InsertObjectValue(size_t index, const std::string &key, JsonValue &&val) noexcept
+    {
+        assert(m_type == JsonType::Object);
+        assert(index <= m_object->values.size());
+        Invalidate();
+        auto &values = DetachObject().values;
+        values.insert(values.begin() + index, std::move(val));
+        auto &keys = DetachShape().keys;
+        keys.emplace(keys.begin() + index, key);
     }
 
     void JsonValue::RemoveObjectValue(size_t index) noexcept
     {
         assert(m_type == JsonType::Object);
-        m_object.erase(m_object.begin() + index, m_object.begin() + index + 1);
+        Invalidate();
+        auto &values = DetachObject().values;
+        values.erase(values.begin() + index);
+        auto &keys = DetachShape().keys;
+        keys.erase(keys.begin() + index);
     }
 
     void JsonValue::ClearObject() noexcept
     {
         assert(m_type == JsonType::Object);
-        m_object.clear();
+        Invalidate();
+        auto &obj = DetachObject();
+        obj.values.clear();
+        obj.shape = EmptyShape();
+    }
+
+    void JsonValue::Patch(const JsonValue &patch)
+    {
+        JsonPatcher(*this, patch);
+    }
+
+    void JsonValue::MergePatch(const JsonValue &patch) noexcept
+    {
+        JsonPatcher::MergePatch(*this, patch);
+    }
+
+    void JsonValue::Diff(const JsonValue &target, JsonValue &patch) const noexcept
+    {
+        JsonDiffer(*this, target, patch);
+    }
+
+    void JsonValue::ExtractColumns(const std::vector<std::string> &fields, std::vector<JsonColumn> &columns) const
+    {
+        JsonColumnExtractor(*this, fields, columns);
+    }
+
+    void JsonValue::Aggregate(JsonAggregate &result) const noexcept
+    {
+        JsonAggregator(*this, result);
+    }
+
+    void JsonValue::Histogram(double lo, double hi, size_t bins, std::vector<size_t> &result) const
+    {
+        JsonAggregator(*this, lo, hi, bins, result);
+    }
+
+    void JsonValue::Stringify(std::string &content, int flags) const noexcept
+    {
+        JsonGenerator(*this, content, flags);
+    }
+
+    void JsonValue::ToCbor(std::string &content) const noexcept
+    {
+        JsonCborEncoder(*this, content);
+    }
+
+    void JsonValue::ToMsgPack(std::string &content) const noexcept
+    {
+        JsonMsgPackEncoder(*this, content);
+    }
+
+    void JsonValue::ToSnapshot(std::string &content) const noexcept
+    {
+        JsonSnapshotWriter(*this, content);
+    }
+
+    std::shared_ptr<const std::string> JsonValue::GetStringifyCache() const noexcept
+    {
+        auto cache = LoadCache();
+        return cache ? cache->text : nullptr;
+    }
+
+    void JsonValue::SetStringifyCache(std::string &&content) const noexcept
+    {
+        auto cache = LoadCache();
+        JsonValueCache next = cache ? *cache : JsonValueCache();
+        next.text = std::make_shared<const std::string>(std::move(content));
+        StoreCache(std::move(next));
+    }
+
+    std::shared_ptr<const std::vector<uint32_t>> JsonValue::GetKeyIndex() const noexcept
+    {
+        // 哈希表保存在 shape 中，共享 shape 的对象只需要建立一次
+        const JsonShape &shape = *m_object->shape;
+        auto index = std::atomic_load(&shape.keyIndex);
+        if (index)
+            return index;
+        // 表的大小取不小于 key 个数两倍的 2 的幂，保证探测序列足够短
+        size_t capacity = 1;
+        while (capacity < shape.keys.size() * 2)
+            capacity <<= 1;
+        auto table = std::make_shared<std::vector<uint32_t>>(capacity, 0);
+        for (size_t i = 0, n = shape.keys.size(); i < n; ++i)
+        {
+            // key 的哈希在创建 key 时已经算好，intern 过的 key 只计算一次
+            size_t pos = shape.keys[i].GetHash() & (capacity - 1);
+            while ((*table)[pos] != 0)
+                pos = (pos + 1) & (capacity - 1);
+            (*table)[pos] = static_cast<uint32_t>(i + 1);
+        }
+        // 两个线程同时建立时后写入的覆盖先写入的，两张表的内容相同
+        index = std::move(table);
+        std::atomic_store(&shape.keyIndex, index);
+        return index;
+    }
+
+    std::shared_ptr<const JsonValueCache> JsonValue::LoadCache() const noexcept
+    {
+        return std::atomic_load(&m_cache);
+    }
+
+    void JsonValue::StoreCache(JsonValueCache &&cache) const noexcept
+    {
+        // 两个线程同时填充时后写入的覆盖先写入的，被覆盖的数据下次用到时重新计算
+        std::atomic_store(&m_cache, std::shared_ptr<const JsonValueCache>(std::make_shared<JsonValueCache>(std::move(cache))));
+    }
+
+    /* 64 位整数的混合函数（splitmix64 的最后一步），让每一位都影响结果 */
+    static size_t HashMix(uint64_t x) noexcept
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return static_cast<size_t>(x);
+    }
+
+    static size_t HashNumber(double d) noexcept
+    {
+        // 0 与 -0 相等，哈希也必须相同
+        return HashMix(std::hash<double>()(d == 0 ? 0.0 : d) + JsonType::Number);
+    }
+
+    size_t JsonValue::GetHash() const noexcept
+    {
+        switch (m_type)
+        {
+        case JsonType::Number:
+            return HashNumber(GetNumber());
+        case JsonType::String:
+            return HashMix(HashKey(GetString()) + m_type);
+        // 与解析后的值相等，哈希也必须相同
+        case JsonType::Raw:
+            return ParseRaw().GetHash();
+        case JsonType::Array:
+        case JsonType::Object:
+            break;
+        default:
+            return HashMix(m_type);
+        }
+        auto cache = LoadCache();
+        if (cache && cache->hasHash)
+            return cache->hash;
+        size_t hash = m_type;
+        if (m_type == JsonType::Array)
+        {
+            // packed 数组的元素哈希与同样数字的 JsonValue 相同
+            if (m_array->packed)
+            {
+                for (double d : m_array->numbers)
+                    hash = HashMix(hash + HashNumber(d));
+            }
+            else
+            {
+                for (auto &element : m_array->values)
+                    hash = HashMix(hash + element.GetHash());
+            }
+        }
+        else
+        {
+            // 对象的每个键值对单独计算后相加，与顺序无关
+            size_t sum = 0;
+            const auto &keys = m_object->shape->keys;
+            const auto &values = m_object->values;
+            for (size_t i = 0; i < values.size(); ++i)
+                sum += HashMix(keys[i].GetHash() ^ values[i].GetHash());
+            hash = HashMix(sum + values.size() + m_type);
+        }
+        JsonValueCache next = cache ? *cache : JsonValueCache();
+        next.hash = hash;
+        next.hasHash = true;
+        StoreCache(std::move(next));
+        return hash;
+    }
+
+    void JsonValue::Invalidate() noexcept
+    {
+        m_cache.reset();
+    }
+
+    JsonValue::ArrayStorage &JsonValue::DetachArray() noexcept
+    {
+        // 存储被其他值共享时先复制这一层，子值的拷贝仍然共享它们各自的存储
+        // 修改之后 packed 数组的元素需要重新生成；boxed 可能正在被共享存储的其他值原子地填充，不拷贝也不直接读写
+        if (m_array.use_count() > 1)
+        {
+            auto storage = std::make_shared<ArrayStorage>();
+            storage->values = m_array->values;
+            storage->numbers = m_array->numbers;
+            storage->packed = m_array->packed;
+            m_array = std::move(storage);
+        }
+        else
+            std::atomic_store(&m_array->boxed, std::shared_ptr<const std::vector<JsonValue>>());
+        return *m_array;
     }
 
-    void JsonValue::Stringify(std::string &content) const noexcept
+    std::vector<JsonValue> &JsonValue::DetachArrayValues() noexcept
     {
-        JsonGenerator(*this, content);
+        auto &arr = DetachArray();
+        if (arr.packed)
+        {
+            arr.values.resize(arr.numbers.size());
+            for (size_t i = 0; i < arr.numbers.size(); ++i)
+                arr.values[i].SetNumber(arr.numbers[i]);
+            std::vector<double>().swap(arr.numbers);
+            arr.packed = false;
+        }
+        return arr.values;
+    }
+
+    const std::vector<JsonValue> &JsonValue::BoxedArray() const noexcept
+    {
+        auto boxed = std::atomic_load(&m_array->boxed);
+        if (boxed)
+            return *boxed;
+        auto values = std::make_shared<std::vector<JsonValue>>(m_array->numbers.size());
+        for (size_t i = 0; i < values->size(); ++i)
+            (*values)[i].SetNumber(m_array->numbers[i]);
+        // 其他线程返回的引用可能指向已经保存的结果，所以只在还没有结果时保存，不能覆盖
+        std::shared_ptr<const std::vector<JsonValue>> created = std::move(values);
+        if (std::atomic_compare_exchange_strong(&m_array->boxed, &boxed, created))
+            return *created;
+        return *boxed;
+    }
+
+    JsonValue::ObjectStorage &JsonValue::DetachObject() noexcept
+    {
+        // 复制出来的存储仍然共享原来的 shape
+        if (m_object.use_count() > 1)
+            m_object = std::make_shared<ObjectStorage>(*m_object);
+        return *m_object;
+    }
+
+    JsonShape &JsonValue::DetachShape() noexcept
+    {
+        auto &obj = DetachObject();
+        if (obj.shape.use_count() > 1)
+        {
+            auto shape = std::make_shared<JsonShape>();
+            shape->keys = obj.shape->keys;
+            obj.shape = std::move(shape);
+        }
+        else
+            obj.shape->keyIndex.reset();
+        return *obj.shape;
     }
 
     void JsonValue::Init(const JsonValue &rhs) noexcept
     {
         m_type = rhs.m_type;
+        // 共享子值的其他拷贝可能正在另一个线程中填充 rhs 的缓存，必须原子地读取
+        m_cache = std::atomic_load(&rhs.m_cache);
         m_num = 0;
         switch (m_type)
         {
         case JsonType::Number:
-            m_num = rhs.m_num;
+            m_numText = rhs.m_numText;
+            if (m_numText)
+                new (&m_string) std::string(rhs.m_string);
+            else
+                m_num = rhs.m_num;
             break;
         case JsonType::String:
+            // 引用外部缓冲区的字符串，拷贝出来的值仍然引用同一个缓冲区
+            m_borrowed = rhs.m_borrowed;
+            m_escaped = rhs.m_escaped;
+            if (m_borrowed)
+                m_view = rhs.m_view;
+            else
+                new (&m_string) std::string(rhs.m_string);
+            break;
+        case JsonType::Raw:
             new (&m_string) std::string(rhs.m_string);
             break;
         case JsonType::Array:
-            new (&m_array) std::vector<JsonValue>(rhs.m_array);
+            // 拷贝只增加引用计数，修改时才复制
+            new (&m_array) ArrayPtr(rhs.m_array);
+            break;
+        case JsonType::Object:
+            new (&m_object) ObjectPtr(rhs.m_object);
+            break;
+        }
+    }
+    void JsonValue::Init(JsonValue &&rhs) noexcept
+    {
+        m_type = rhs.m_type;
+        m_cache = std::atomic_exchange(&rhs.m_cache, std::shared_ptr<const JsonValueCache>());
+        m_num = 0;
+        switch (m_type)
+        {
+        case JsonType::Number:
+            m_numText = rhs.m_numText;
+            if (m_numText)
+                new (&m_string) std::string(std::move(rhs.m_string));
+            else
+                m_num = rhs.m_num;
+            break;
+        case JsonType::String:
+            m_borrowed = rhs.m_borrowed;
+            m_escaped = rhs.m_escaped;
+            if (m_borrowed)
+                m_view = rhs.m_view;
+            else
+                new (&m_string) std::string(std::move(rhs.m_string));
+            break;
+        case JsonType::Raw:
+            new (&m_string) std::string(std::move(rhs.m_string));
+            break;
+        case JsonType::Array:
+            new (&m_array) ArrayPtr(std::move(rhs.m_array));
             break;
         case JsonType::Object:
-            new (&m_object) std::vector<std::pair<std::string, JsonValue>>(rhs.m_object);
+            new (&m_object) ObjectPtr(std::move(rhs.m_object));
             break;
         }
+        // 转移之后 rhs 只剩下空的容器，释放掉并置为 null
+        rhs.Free();
+        rhs.m_type = JsonType::Null;
     }
     void JsonValue::Free() noexcept
     {
         using std::string;
         switch (m_type)
         {
+        case JsonType::Number:
+            if (m_numText)
+                m_string.~string();
+            m_numText = false;
+            break;
         case JsonType::String:
-            m_string.~string(); // 显式调用相应的析构函数
+            if (!m_borrowed)
+                m_string.~string(); // 显式调用相应的析构函数
+            m_borrowed = false;
+            m_escaped = false;
+            break;
+        case JsonType::Raw:
+            m_string.~string();
             break;
         case JsonType::Array:
-            m_array.~vector<JsonValue>();
+            m_array.~ArrayPtr();
             break;
         case JsonType::Object:
-            m_object.~vector<std::pair<std::string, JsonValue>>();
+            m_object.~ObjectPtr();
         }
     }
+    /* 两边都已经缓存了哈希并且哈希不同时，一定不相等 */
+    static bool HashMismatch(const std::shared_ptr<const JsonValueCache> &lhs, const std::shared_ptr<const JsonValueCache> &rhs) noexcept
+    {
+        return lhs && rhs && lhs->hasHash && rhs->hasHash && lhs->hash != rhs->hash;
+    }
     bool operator==(const JsonValue &lhs, const JsonValue &rhs) noexcept
     {
+        // raw 文本按解析后的值比较，文本完全相同时不需要解析
+        if (lhs.m_type == JsonType::Raw || rhs.m_type == JsonType::Raw)
+        {
+            if (lhs.m_type == rhs.m_type && lhs.m_string == rhs.m_string)
+                return true;
+            return (lhs.m_type == JsonType::Raw ? lhs.ParseRaw() : lhs) == (rhs.m_type == JsonType::Raw ? rhs.ParseRaw() : rhs);
+        }
         if (lhs.m_type != rhs.m_type)
             return false;
         // 对于 true、false、null 这三种类型，比较类型后便完成比较。而对于数组、对象、数字、字符串，需要进一步检查是否相等
         switch (lhs.m_type)
         {
         case JsonType::Number:
-            return lhs.m_num == rhs.m_num;
+            return lhs.GetNumber() == rhs.GetNumber();
         case JsonType::String:
-            return lhs.m_string == rhs.m_string;
+            return lhs.GetString() == rhs.GetString();
         case JsonType::Array:
-            return lhs.m_array == rhs.m_array;
+        {
+            // 共享同一份存储时一定相等
+            if (lhs.m_array == rhs.m_array)
+                return true;
+            const size_t n = lhs.GetArraySize();
+            if (n != rhs.GetArraySize() || HashMismatch(lhs.LoadCache(), rhs.LoadCache()))
+                return false;
+            const double *lnumbers = lhs.GetArrayNumbers(), *rnumbers = rhs.GetArrayNumbers();
+            if (!lnumbers && !rnumbers)
+                return lhs.m_array->values == rhs.m_array->values;
+            // 至少一边是 packed 数组，直接比较数字，不生成 JsonValue
+            for (size_t i = 0; i < n; ++i)
+            {
+                const JsonValue *l = lnumbers ? nullptr : &lhs.m_array->values[i];
+                const JsonValue *r = rnumbers ? nullptr : &rhs.m_array->values[i];
+                if ((l && l->m_type != JsonType::Number) || (r && r->m_type != JsonType::Number))
+                    return false;
+                if ((l ? l->GetNumber() : lnumbers[i]) != (r ? r->GetNumber() : rnumbers[i]))
+                    return false;
+            }
+            return true;
+        }
         case JsonType::Object:
+        {
+            if (lhs.m_object == rhs.m_object)
+                return true;
             // 对于对象，先比较键值对的个数是否相等
-            if (lhs.GetObjectSize() != rhs.GetObjectSize())
+            const size_t n = lhs.GetObjectSize();
+            if (n != rhs.GetObjectSize() || HashMismatch(lhs.LoadCache(), rhs.LoadCache()))
                 return false;
-            // 相等的话，对左边的键值对，依次在右边进行寻找
-            for (size_t i = 0, n = lhs.GetObjectSize(); i < n; i++)
+            // shape 相同时 key 的顺序完全相同，按位置比较 value
+            const auto &lkeys = lhs.m_object->shape->keys;
+            const auto &rkeys = rhs.m_object->shape->keys;
+            if (lhs.m_object->shape == rhs.m_object->shape && lhs.m_object->values == rhs.m_object->values)
+                return true;
+            // 对左边的每个键值对，通过右边的 key 哈希表找到对应的键值对，整体是 O(n) 的。
+            // 有重复的 key 时，右边的每个键值对只能匹配一次，这样相等的结果与键值对的顺序无关。
+            // 记录右边哪些键值对已经匹配过，key 不多时用一个整数的各个位记录，避免分配内存
+            uint64_t usedBits = 0;
+            std::vector<bool> used(n > 64 ? n : 0, false);
+            auto isUsed = [&](size_t j) { return n > 64 ? bool(used[j]) : ((usedBits >> j) & 1) != 0; };
+            for (size_t i = 0; i < n; i++)
             {
-                // 根据左边对象的键值对，在右边对象中寻找相对应的索引
-                auto index = rhs.FindObjectIndex(lhs.GetObjectKey(i));
-                // key 不存在或者左右对象的 value 值不相等，直接返回 0
-                if (index < 0 || lhs.GetObjectValue(i) != rhs.GetObjectValue(index))
+                const JsonKey &key = lkeys[i];
+                long long index = rhs.FindObjectIndex(key.GetString(), key.GetHash());
+                if (index < 0)
                     return false;
+                size_t j = static_cast<size_t>(index);
+                while (j < n && (isUsed(j) || rkeys[j] != key || lhs.GetObjectValue(i) != rhs.GetObjectValue(j)))
+                    ++j;
+                if (j == n)
+                    return false;
+                if (n > 64)
+                    used[j] = true;
+                else
+                    usedBits |= uint64_t(1) << j;
             }
             return true;
+        }
         default:
             return true;
         }
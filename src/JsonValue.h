@@ -1,11 +1,32 @@
 #ifndef JSONVALUE_H
 #define JSONVALUE_H
 #include "Json.h"
+#include "JsonKeyTable.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <utility>
 #include <string>
+#include <string_view>
 namespace SJson
 {
+    struct JsonShape;
+    struct JsonColumn;
+    struct JsonAggregate;
+    /*
+     * 由值的内容推导出来、随时可以重新计算的数据。拷贝出来的值共享同一份缓存；
+     * 缓存本身不会被修改，填充新的数据时整体替换，所以多个线程同时读取同一个值是安全的。
+     */
+    struct JsonValueCache
+    {
+        /* 序列化的结果 */
+        std::shared_ptr<const std::string> text;
+        /* 数组和对象的结构哈希 */
+        size_t hash = 0;
+        bool hasHash = false;
+        /* 延迟解码的字符串第一次读取时解码出来的结果 */
+        std::shared_ptr<const std::string> decoded;
+    };
     class JsonValue
     {
     public:
@@ -13,57 +34,182 @@ namespace SJson
         JsonValue() noexcept { m_num = 0; }
         JsonValue(const JsonValue &rhs) noexcept { Init(rhs); }
         JsonValue &operator=(const JsonValue &rhs) noexcept;
+        /* 移动之后 rhs 变为 null */
+        JsonValue(JsonValue &&rhs) noexcept { Init(std::move(rhs)); }
+        JsonValue &operator=(JsonValue &&rhs) noexcept;
         ~JsonValue() noexcept;
 
         /* null true false */
         int GetType() const noexcept;
         void SetType(JsonType::type t);
-        void Parse(const std::string &content);
+        void Parse(const std::string &content, int flags);
+        void Parse(const std::string &content, JsonKeyTable &keys, int flags);
+        void ParseCbor(const std::string &content);
+        void ParseMsgPack(const std::string &content, int flags);
 
         /* number */
         double GetNumber() const noexcept;
         void SetNumber(double d) noexcept;
+        /* 保存数字的原文，GetNumber 时才转换，序列化时原样输出；text 必须是合法的 json 数字 */
+        void SetNumberText(std::string &&text) noexcept;
+        /* 数字的原文，数字不是由 SetNumberText 设置时为空 */
+        std::string_view GetNumberText() const noexcept;
 
         /* string */
-        const std::string &GetString() const noexcept;
+        std::string_view GetString() const noexcept;
         void SetString(const std::string &str) noexcept;
+        void SetString(std::string &&str) noexcept;
+        /* 直接引用外部缓冲区中的字符串而不拷贝，调用者需要保证缓冲区比这个值活得更久 */
+        void SetStringView(const char *data, size_t size) noexcept;
+        /* 引用外部缓冲区中带引号、仍然转义的字符串原文，第一次 GetString 时才解码；原文必须是合法的 json 字符串 */
+        void SetEscapedStringView(const char *data, size_t size) noexcept;
+        /* 延迟解码的字符串返回带引号的原文，否则返回空 */
+        std::string_view GetEscapedString() const noexcept;
+
+        /* raw：原样保存的 json 文本，与字符串共用存储 */
+        const std::string &GetRaw() const noexcept;
+        void SetRaw(const std::string &content) noexcept;
+        void SetRaw(std::string &&content) noexcept;
+        /* 解析 raw 文本得到的值，文本不合法时为 null；比较、哈希以及二进制编码都使用解析后的值 */
+        JsonValue ParseRaw() const noexcept;
 
         /* array */
         size_t GetArraySize() const noexcept;
         const JsonValue &GetArrayElement(size_t index) const noexcept;
+        /* 取得可以修改的元素，本值的缓存随之失效 */
+        JsonValue &MutableArrayElement(size_t index) noexcept;
         void SetArray(const std::vector<JsonValue> &arr) noexcept;
+        void SetArray(std::vector<JsonValue> &&arr) noexcept;
+        /* 元素全部是数字的数组，紧凑地保存为连续的 double */
+        void SetArray(std::vector<double> &&numbers) noexcept;
+        /* 数组紧凑保存数字时返回连续的数字，否则返回 nullptr；空数组也可能返回 nullptr */
+        const double *GetArrayNumbers() const noexcept;
+        void ReserveArray(size_t capacity) noexcept;
         void PushbackArrayElement(const JsonValue &val) noexcept;
+        void PushbackArrayElement(JsonValue &&val) noexcept;
         void PopbackArrayElement() noexcept;
         void EraseArrayElement(size_t index, size_t count) noexcept;
         void InsertArrayElement(const JsonValue &val, size_t index) noexcept;
+        void InsertArrayElement(JsonValue &&val, size_t index) noexcept;
         void ClearArray() noexcept;
 
         /* object */
-        void SetObject(const std::vector<std::pair<std::string, JsonValue>> &obj) noexcept;
+        void SetObject(const std::vector<std::pair<JsonKey, JsonValue>> &obj) noexcept;
+        void SetObject(std::vector<std::pair<JsonKey, JsonValue>> &&obj) noexcept;
+        /* values 依次对应 shape 中的 key */
+        void SetObject(std::shared_ptr<JsonShape> shape, std::vector<JsonValue> &&values) noexcept;
+        void ReserveObject(size_t capacity) noexcept;
         size_t GetObjectSize() const noexcept;
         const std::string &GetObjectKey(size_t index) const noexcept;
         const JsonValue &GetObjectValue(size_t index) const noexcept;
+        /* 取得可以修改的 value，本值的缓存随之失效，key 的哈希表仍然有效 */
+        JsonValue &MutableObjectValue(size_t index) noexcept;
         size_t GetObjectKeyLength(size_t index) const noexcept;
         long long FindObjectIndex(const std::string &key) const noexcept;
+        /* hash 必须是 HashKey(key) 的结果，可以预先计算后重复使用 */
+        long long FindObjectIndex(std::string_view key, size_t hash) const noexcept;
+        /* 对象的 shape：shape 相同的两个对象 key 的顺序完全相同，查找到的下标可以互相使用 */
+        const JsonShape *GetObjectShape() const noexcept;
+        static size_t HashKey(std::string_view key) noexcept;
         void SetObjectValue(const std::string &key, const JsonValue &val) noexcept;
+        void SetObjectValue(const std::string &key, JsonValue &&val) noexcept;
+        /* 在末尾追加键值对，不检查 key 是否已经存在 */
+        void EmplaceObjectValue(std::string &&key, JsonValue &&val) noexcept;
+        /* 在 index 处插入键值对，不检查 key 是否已经存在 */
+        void InsertObjectValue(size_t index, const std::string &key, JsonValue &&val) noexcept;
         void RemoveObjectValue(size_t index) noexcept;
         void ClearObject() noexcept;
+        /* 结构哈希：相等的值哈希相同，对象的哈希与 key 的顺序无关，数组和对象的结果会被缓存 */
+        size_t GetHash() const noexcept;
+        /* patch */
+        void Patch(const JsonValue &patch);
+        void MergePatch(const JsonValue &patch) noexcept;
+        /* 生成把当前值变为 target 的 JSON Patch */
+        void Diff(const JsonValue &target, JsonValue &patch) const noexcept;
+        /* 把对象数组中的字段取出为列 */
+        void ExtractColumns(const std::vector<std::string> &fields, std::vector<JsonColumn> &columns) const;
+        /* 数组中数字的统计与直方图 */
+        void Aggregate(JsonAggregate &result) const noexcept;
+        void Histogram(double lo, double hi, size_t bins, std::vector<size_t> &result) const;
         /* serialize */
-        void Stringify(std::string &content) const noexcept;
+        void Stringify(std::string &content, int flags) const noexcept;
+        void ToCbor(std::string &content) const noexcept;
+        void ToMsgPack(std::string &content) const noexcept;
+        void ToSnapshot(std::string &content) const noexcept;
+        /* 序列化缓存：值被修改后缓存失效，返回 nullptr */
+        std::shared_ptr<const std::string> GetStringifyCache() const noexcept;
+        void SetStringifyCache(std::string &&content) const noexcept;
 
     private:
+        /*
+         * 数组的存储：元素全部是数字时可以只保存 double（packed），插入其他类型的值或者取得可修改的元素时转换为 JsonValue。
+         * packed 数组按 JsonValue 读取元素时，一次性生成所有元素的 JsonValue 并保存在 boxed 中。
+         */
+        struct ArrayStorage
+        {
+            ArrayStorage() = default;
+            /* boxed 只能通过原子操作访问，不能随存储一起拷贝 */
+            ArrayStorage(const ArrayStorage &) = delete;
+            ArrayStorage &operator=(const ArrayStorage &) = delete;
+            std::vector<JsonValue> values;
+            std::vector<double> numbers;
+            bool packed = false;
+            mutable std::shared_ptr<const std::vector<JsonValue>> boxed;
+        };
+        /* key 列表保存在可以共享的 shape 中，对象本身只保存 value */
+        struct ObjectStorage
+        {
+            std::shared_ptr<JsonShape> shape;
+            std::vector<JsonValue> values;
+        };
+        using ArrayPtr = std::shared_ptr<ArrayStorage>;
+        using ObjectPtr = std::shared_ptr<ObjectStorage>;
         /* 初始化 JsonValue 与释放 JsonValue 的内存 */
 
         void Init(const JsonValue &rhs) noexcept;
+        void Init(JsonValue &&rhs) noexcept;
         void Free() noexcept;
+        /* 修改数组或对象之前调用，取得不与其他值共享的存储 */
+        ArrayStorage &DetachArray() noexcept;
+        /* 在 DetachArray 的基础上把 packed 数组转换为 JsonValue 数组 */
+        std::vector<JsonValue> &DetachArrayValues() noexcept;
+        /* packed 数组的元素按 JsonValue 读取时使用，第一次调用时生成 */
+        const std::vector<JsonValue> &BoxedArray() const noexcept;
+        ObjectStorage &DetachObject() noexcept;
+        /* 修改对象的 key 之前调用，取得不与其他对象共享的 shape，并丢弃 shape 的 key 哈希表 */
+        JsonShape &DetachShape() noexcept;
+        /* 值被修改时调用，丢弃过期的缓存 */
+        void Invalidate() noexcept;
+        std::shared_ptr<const JsonValueCache> LoadCache() const noexcept;
+        void StoreCache(JsonValueCache &&cache) const noexcept;
+        /* 延迟解码的字符串：第一次调用时解码并保存到缓存中 */
+        std::string_view DecodedString() const noexcept;
+        /* 线性查找对象的 key */
+        long long ScanObjectIndex(std::string_view key) const noexcept;
+        /* 取得 shape 的 key 哈希表，第一次查找时建立 */
+        std::shared_ptr<const std::vector<uint32_t>> GetKeyIndex() const noexcept;
         JsonType::type m_type = JsonType::Null;
+        /* 字符串是否引用外部缓冲区（m_view），否则由 m_string 持有 */
+        bool m_borrowed = false;
+        /* 数字是否保存为原文（m_string），否则保存在 m_num 中 */
+        bool m_numText = false;
+        /* 引用外部缓冲区的字符串是否仍然转义，这时 m_view 包括两边的引号 */
+        bool m_escaped = false;
+        /* 拷贝出来的值共享同一份缓存，所以用 shared_ptr 保存 */
+        mutable std::shared_ptr<const JsonValueCache> m_cache;
 
         union
         {
             double m_num;
             std::string m_string;
-            std::vector<JsonValue> m_array;
-            std::vector<std::pair<std::string, JsonValue>> m_object;
+            struct
+            {
+                const char *data;
+                size_t size;
+            } m_view;
+            /* 数组和对象的存储在拷贝之间共享（写时复制），修改时只复制被修改的那一层 */
+            ArrayPtr m_array;
+            ObjectPtr m_object;
         };
         friend bool operator==(const JsonValue &lhs, const JsonValue &rhs) noexcept;
     };
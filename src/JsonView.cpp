@@ -0,0 +1,147 @@
+#include "Json.h"
+#include "JsonValue.h"
+#include "JsonPointer.h"
+#include "JsonPath.h"
+#include "JsonColumn.h"
+#include "JsonAggregate.h"
+#include "JsonException.h"
+#include <cassert>
+namespace SJson
+{
+    JsonView::JsonView(const Json &json) noexcept : m_Value(json.m_Value.get()) {}
+
+    bool JsonView::IsValid() const noexcept
+    {
+        return m_Value != nullptr;
+    }
+
+    int JsonView::GetType() const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetType();
+    }
+
+    double JsonView::GetNumber() const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetNumber();
+    }
+
+    std::string_view JsonView::GetNumberText() const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetNumberText();
+    }
+
+    std::string_view JsonView::GetString() const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetString();
+    }
+
+    std::string_view JsonView::GetRaw() const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetRaw();
+    }
+
+    size_t JsonView::GetArraySize() const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetArraySize();
+    }
+
+    JsonView JsonView::GetArrayElement(size_t index) const noexcept
+    {
+        assert(m_Value != nullptr);
+        return JsonView(&m_Value->GetArrayElement(index));
+    }
+
+    size_t JsonView::GetObjectSize() const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetObjectSize();
+    }
+
+    const std::string &JsonView::GetObjectKey(size_t index) const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->GetObjectKey(index);
+    }
+
+    JsonView JsonView::GetObjectValue(size_t index) const noexcept
+    {
+        assert(m_Value != nullptr);
+        return JsonView(&m_Value->GetObjectValue(index));
+    }
+
+    long long JsonView::FindObjectIndex(const std::string &key) const noexcept
+    {
+        assert(m_Value != nullptr);
+        return m_Value->FindObjectIndex(key);
+    }
+
+    JsonView JsonView::At(const JsonPointer &ptr) const
+    {
+        JsonView ret = Find(ptr);
+        if (!ret.IsValid())
+            throw(JsonException("pointer not found"));
+        return ret;
+    }
+
+    JsonView JsonView::Find(const JsonPointer &ptr) const noexcept
+    {
+        assert(m_Value != nullptr);
+        return JsonView(ptr.Resolve(*m_Value));
+    }
+
+    std::vector<JsonView> JsonView::Query(const JsonPath &path) const
+    {
+        assert(m_Value != nullptr);
+        std::vector<const JsonValue *> nodes;
+        path.Evaluate(*m_Value, nodes);
+        std::vector<JsonView> ret;
+        ret.reserve(nodes.size());
+        for (auto val : nodes)
+            ret.push_back(JsonView(val));
+        return ret;
+    }
+
+    std::vector<JsonColumn> JsonView::ExtractColumns(const std::vector<std::string> &fields) const
+    {
+        assert(m_Value != nullptr);
+        std::vector<JsonColumn> columns;
+        m_Value->ExtractColumns(fields, columns);
+        return columns;
+    }
+
+    JsonAggregate JsonView::Aggregate() const noexcept
+    {
+        assert(m_Value != nullptr);
+        JsonAggregate result;
+        m_Value->Aggregate(result);
+        return result;
+    }
+
+    std::vector<size_t> JsonView::Histogram(double lo, double hi, size_t bins) const
+    {
+        assert(m_Value != nullptr);
+        std::vector<size_t> result;
+        m_Value->Histogram(lo, hi, bins, result);
+        return result;
+    }
+
+    void JsonView::Stringify(std::string &content, int flags) const noexcept
+    {
+        assert(m_Value != nullptr);
+        m_Value->Stringify(content, flags);
+    }
+
+    Json JsonView::ToJson() const noexcept
+    {
+        assert(m_Value != nullptr);
+        Json ret;
+        *ret.m_Value = *m_Value;
+        return ret;
+    }
+}
@@ -1,6 +1,18 @@
 #include <gtest/gtest.h>
 #include "../src/Json.h"
+#include "../src/JsonAggregate.h"
+#include "../src/JsonColumn.h"
+#include "../src/JsonException.h"
+#include "../src/JsonKeyTable.h"
+#include "../src/JsonPath.h"
+#include "../src/JsonPointer.h"
+#include "../src/JsonSnapshot.h"
+#include "../src/JsonTape.h"
+#include <cmath>
+#include <cstring>
 #include <string>
+#include <thread>
+#include <unordered_set>
 
 static std::string status;
 
@@ -406,6 +418,761 @@ TEST(TestStringify, Stringify)
     test_roundtrip("false");
 }
 
+// 测试序列化大数组和大对象（多线程生成）
+TEST(TestStringifyLarge, StringifyLarge)
+{
+    SJson::Json a, o, e;
+    std::string expectArray = "[", expectObject = "{";
+    a.SetArray();
+    o.SetObject();
+    for (int i = 0; i < 12000; ++i)
+    {
+        std::string s = std::to_string(i);
+        e.SetNumber(i);
+        a.PushbackArrayElement(e);
+        e.SetString(s);
+        o.SetObjectValue("k" + s, e);
+        if (i > 0)
+        {
+            expectArray += ',';
+            expectObject += ',';
+        }
+        expectArray += s;
+        expectObject += "\"k" + s + "\":\"" + s + "\"";
+    }
+    expectArray += ']';
+    expectObject += '}';
+
+    a.Stringify(status);
+    EXPECT_EQ(expectArray, status);
+    o.Stringify(status);
+    EXPECT_EQ(expectObject, status);
+}
+
+// 测试序列化缓存：修改子树后缓存失效，结果与不使用缓存时一致
+TEST(TestStringifyCache, StringifyCache)
+{
+    using namespace SJson;
+    SJson::Json v, e;
+    std::string expect;
+    v.Parse("{\"name\":\"config\",\"servers\":[{\"host\":\"alpha.example.com\",\"port\":8080},"
+            "{\"host\":\"beta.example.com\",\"port\":8081}],\"limits\":{\"cpu\":4,\"memory\":\"16 GiB\",\"disk\":\"512 GiB\"}}");
+    v.Stringify(expect);
+    v.Stringify(status, StringifyFlag::Cache);
+    EXPECT_EQ(expect, status);
+    v.Stringify(status, StringifyFlag::Cache);
+    EXPECT_EQ(expect, status);
+
+    // 修改嵌套的值：取出子对象，修改后再放回
+    SJson::Json servers = v.GetObjectValue(v.FindObjectIndex("servers"));
+    SJson::Json server = servers.GetArrayElement(1);
+    e.SetNumber(9090);
+    server.SetObjectValue("port", e);
+    servers.EraseArrayElement(1, 1);
+    servers.PushbackArrayElement(server);
+    v.SetObjectValue("servers", servers);
+
+    v.Stringify(expect);
+    v.Stringify(status, StringifyFlag::Cache);
+    EXPECT_EQ(expect, status);
+    EXPECT_NE(std::string::npos, status.find("9090"));
+
+    e.SetString("32 GiB");
+    SJson::Json limits = v.GetObjectValue(v.FindObjectIndex("limits"));
+    limits.SetObjectValue("memory", e);
+    v.SetObjectValue("limits", limits);
+    v.Stringify(expect);
+    v.Stringify(status, StringifyFlag::Cache);
+    EXPECT_EQ(expect, status);
+}
+
+#define test_canonical(expect, content)                       \
+    do                                                        \
+    {                                                         \
+        SJson::Json v;                                        \
+        v.Parse(content, status);                             \
+        EXPECT_EQ("parse ok", status);                        \
+        v.Stringify(status, SJson::StringifyFlag::Canonical); \
+        EXPECT_EQ(expect, status);                            \
+    } while (0)
+
+// 测试规范化输出（RFC 8785）
+TEST(TestStringifyCanonical, StringifyCanonical)
+{
+    test_canonical("0", "-0");
+    test_canonical("4.5", "4.50");
+    test_canonical("0.002", "2e-3");
+    test_canonical("1e+30", "1E30");
+    test_canonical("1e-27", "0.000000000000000000000000001");
+    test_canonical("333333333.3333333", "333333333.33333329");
+    test_canonical("100000000000000000000", "1e20");
+    test_canonical("1e+21", "1e21");
+    test_canonical("0.000001", "1e-6");
+    test_canonical("1e-7", "1e-7");
+    test_canonical("-1.5", "-1.5");
+    test_canonical("5e-324", "4.9406564584124654e-324");
+    test_canonical("\"\\u001f\\n\"", "\"\\u001F\\n\"");
+    test_canonical("{\"a\":[1,{\"x\":true,\"y\":null}],\"b\":\"\xE2\x82\xAC\"}", " { \"b\" : \"\\u20ac\" , \"a\" : [ 1 , { \"y\" : null , \"x\" : true } ] } ");
+    // key 按 UTF-16 编码单元排序
+    test_canonical("{\"\\r\":1,\"1\":2,\"\xC2\x80\":3,\"\xC3\xB6\":4,\"\xE2\x82\xAC\":5,\"\xF0\x9F\x98\x80\":6,\"\xEF\xAC\xB3\":7}",
+                   "{\"\\u20ac\":5,\"\\r\":1,\"\\ufb33\":7,\"1\":2,\"\\ud83d\\ude00\":6,\"\\u0080\":3,\"\\u00f6\":4}");
+
+    // 无穷大和 NaN 不是合法的 json 数字，输出为 null
+    SJson::Json v, inf, ninf, nan;
+    inf.SetNumber(HUGE_VAL);
+    ninf.SetNumber(-HUGE_VAL);
+    nan.SetNumber(std::nan(""));
+    v.SetArray();
+    v.PushbackArrayElement(inf);
+    v.PushbackArrayElement(ninf);
+    v.PushbackArrayElement(nan);
+    v.Stringify(status, SJson::StringifyFlag::Canonical);
+    EXPECT_EQ("[null,null,null]", status);
+    v.Stringify(status);
+    EXPECT_EQ("[null,null,null]", status);
+}
+
+#define test_cbor_roundtrip(content)   \
+    do                                 \
+    {                                  \
+        SJson::Json v1, v2;            \
+        std::string bytes;             \
+        v1.Parse(content);             \
+        v1.ToCbor(bytes);              \
+        v2.ParseCbor(bytes, status);   \
+        EXPECT_EQ("parse ok", status); \
+        EXPECT_EQ(1, int(v1 == v2));   \
+        v2.Stringify(status);          \
+        EXPECT_EQ(content, status);    \
+    } while (0)
+
+#define test_cbor_encode(expect, content)                          \
+    do                                                             \
+    {                                                              \
+        SJson::Json v;                                             \
+        std::string bytes;                                         \
+        v.Parse(content);                                          \
+        v.ToCbor(bytes);                                           \
+        EXPECT_EQ(std::string(expect, sizeof(expect) - 1), bytes); \
+    } while (0)
+
+#define test_cbor_decode(expect, bytes)                             \
+    do                                                              \
+    {                                                               \
+        SJson::Json v;                                              \
+        v.ParseCbor(std::string(bytes, sizeof(bytes) - 1), status); \
+        EXPECT_EQ("parse ok", status);                              \
+        v.Stringify(status);                                        \
+        EXPECT_EQ(expect, status);                                  \
+    } while (0)
+
+#define test_cbor_error(error, bytes)                               \
+    do                                                              \
+    {                                                               \
+        SJson::Json v;                                              \
+        v.ParseCbor(std::string(bytes, sizeof(bytes) - 1), status); \
+        EXPECT_EQ(error, status);                                   \
+        EXPECT_EQ(SJson::JsonType::Null, v.GetType());              \
+    } while (0)
+
+// 测试 CBOR 编码与解码
+TEST(TestCbor, Cbor)
+{
+    test_cbor_encode("\x00", "0");
+    test_cbor_encode("\x18\x64", "100");
+    test_cbor_encode("\x19\x03\xe8", "1000");
+    test_cbor_encode("\x20", "-1");
+    test_cbor_encode("\x39\x03\xe7", "-1000");
+    test_cbor_encode("\x1b\x00\x1f\xff\xff\xff\xff\xff\xff", "9007199254740991");
+    test_cbor_encode("\xfa\x3f\xc0\x00\x00", "1.5");
+    test_cbor_encode("\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a", "1.1");
+    test_cbor_encode("\x83\xf6\xf5\xf4", "[null,true,false]");
+    test_cbor_encode("\x83\x01\x02\x03", "[1,2,3]");
+    test_cbor_encode("\xa2\x61\x61\x01\x61\x62\x82\x02\x03", "{\"a\":1,\"b\":[2,3]}");
+    test_cbor_encode("\x64\x49\x45\x54\x46", "\"IETF\"");
+
+    test_cbor_decode("1.5", "\xf9\x3e\x00");
+    test_cbor_decode("-4", "\xf9\xc4\x00");
+    test_cbor_decode("5.9604644775390625e-08", "\xf9\x00\x01");
+    test_cbor_decode("1.8446744073709552e+19", "\x1b\xff\xff\xff\xff\xff\xff\xff\xff");
+    test_cbor_decode("[1,[2,3],[4,5]]", "\x9f\x01\x82\x02\x03\x9f\x04\x05\xff\xff");
+    test_cbor_decode("\"streaming\"", "\x7f\x65\x73\x74\x72\x65\x61\x64\x6d\x69\x6e\x67\xff");
+    test_cbor_decode("{\"Fun\":true,\"Amt\":-2}", "\xbf\x63\x46\x75\x6e\xf5\x63\x41\x6d\x74\x21\xff");
+    test_cbor_decode("1363896240", "\xc1\x1a\x51\x4b\x67\xb0");
+    test_cbor_decode("null", "\xf7");
+
+    test_cbor_roundtrip("null");
+    test_cbor_roundtrip("-0");
+    test_cbor_roundtrip("1.0000000000000002");
+    test_cbor_roundtrip("-1.7976931348623157e+308");
+    test_cbor_roundtrip("4.9406564584124654e-324");
+    test_cbor_roundtrip("-9.2233720368547758e+18");
+    test_cbor_roundtrip("\"Hello\\u0000World\\n\"");
+    test_cbor_roundtrip("{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
+
+    test_cbor_error("cbor unexpected end", "");
+    test_cbor_error("cbor unexpected end", "\x83\x01\x02");
+    test_cbor_error("cbor unexpected end", "\x65\x61\x62");
+    test_cbor_error("cbor root not singular", "\x01\x02");
+    test_cbor_error("cbor unsupported type", "\x42\x01\x02");
+    test_cbor_error("cbor invalid key", "\xa1\x01\x02");
+    test_cbor_error("cbor invalid number", "\xf9\x7c\x00");
+    test_cbor_error("cbor invalid additional info", "\x1c");
+}
+
+#define test_msgpack_roundtrip(content, flags) \
+    do                                         \
+    {                                          \
+        SJson::Json v1, v2;                    \
+        std::string bytes;                     \
+        v1.Parse(content);                     \
+        v1.ToMsgPack(bytes);                   \
+        v2.ParseMsgPack(bytes, status, flags); \
+        EXPECT_EQ("parse ok", status);         \
+        EXPECT_EQ(1, int(v1 == v2));           \
+        v2.Stringify(status);                  \
+        EXPECT_EQ(content, status);            \
+    } while (0)
+
+#define test_msgpack_encode(expect, content)                       \
+    do                                                             \
+    {                                                              \
+        SJson::Json v;                                             \
+        std::string bytes;                                         \
+        v.Parse(content);                                          \
+        v.ToMsgPack(bytes);                                        \
+        EXPECT_EQ(std::string(expect, sizeof(expect) - 1), bytes); \
+    } while (0)
+
+#define test_msgpack_error(error, bytes)                               \
+    do                                                                 \
+    {                                                                  \
+        SJson::Json v;                                                 \
+        v.ParseMsgPack(std::string(bytes, sizeof(bytes) - 1), status); \
+        EXPECT_EQ(error, status);                                      \
+        EXPECT_EQ(SJson::JsonType::Null, v.GetType());                 \
+    } while (0)
+
+// 测试 MessagePack 编码与解码
+TEST(TestMsgPack, MsgPack)
+{
+    using namespace SJson;
+    test_msgpack_encode("\x00", "0");
+    test_msgpack_encode("\x7f", "127");
+    test_msgpack_encode("\xcc\x80", "128");
+    test_msgpack_encode("\xcd\x01\x00", "256");
+    test_msgpack_encode("\xff", "-1");
+    test_msgpack_encode("\xe0", "-32");
+    test_msgpack_encode("\xd0\xdf", "-33");
+    test_msgpack_encode("\xd1\xfc\x18", "-1000");
+    test_msgpack_encode("\xca\x3f\xc0\x00\x00", "1.5");
+    test_msgpack_encode("\x93\xc0\xc3\xc2", "[null,true,false]");
+    test_msgpack_encode("\x82\xa1\x61\x01\xa1\x62\xa3\x61\x62\x63", "{\"a\":1,\"b\":\"abc\"}");
+
+    const char *roundtrips[] = {
+        "null",
+        "-0",
+        "4294967296",
+        "-2147483649",
+        "1.0000000000000002",
+        "\"Hello\\u0000World\\n\"",
+        "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}",
+    };
+    for (const char *content : roundtrips)
+    {
+        test_msgpack_roundtrip(std::string(content), ParseFlag::Default);
+        test_msgpack_roundtrip(std::string(content), ParseFlag::ZeroCopy);
+    }
+
+    // 长字符串、长数组与大对象使用 16 位和 32 位的长度
+    {
+        SJson::Json v1, v2, e;
+        std::string bytes;
+        v1.SetObject();
+        e.SetString(std::string(70000, 'x'));
+        v1.SetObjectValue("long", e);
+        e.SetArray();
+        SJson::Json n;
+        for (int i = 0; i < 100; ++i)
+        {
+            n.SetNumber(i * 1000.5);
+            e.PushbackArrayElement(n);
+        }
+        v1.SetObjectValue("array", e);
+        v1.ToMsgPack(bytes);
+        v2.ParseMsgPack(bytes, ParseFlag::ZeroCopy);
+        EXPECT_EQ(1, int(v1 == v2));
+
+        // 修改零拷贝解码出来的字符串，不影响输入缓冲区
+        SJson::Json s = v2.GetObjectValue(v2.FindObjectIndex("long"));
+        s.SetString("short");
+        v2.SetObjectValue("long", s);
+        EXPECT_EQ("short", v2.GetObjectValue(v2.FindObjectIndex("long")).GetString());
+        v1.ParseMsgPack(bytes);
+        EXPECT_EQ(70000, v1.GetObjectValue(v1.FindObjectIndex("long")).GetString().size());
+    }
+
+    test_msgpack_error("msgpack unexpected end", "");
+    test_msgpack_error("msgpack unexpected end", "\x93\x01\x02");
+    test_msgpack_error("msgpack unexpected end", "\xa3\x61\x62");
+    test_msgpack_error("msgpack unexpected end", "\xcd\x01");
+    test_msgpack_error("msgpack root not singular", "\x01\x02");
+    test_msgpack_error("msgpack unsupported type", "\xc4\x01\x00");
+    test_msgpack_error("msgpack unsupported type", "\xc1");
+    test_msgpack_error("msgpack invalid key", "\x81\x01\x02");
+    test_msgpack_error("msgpack invalid number", "\xca\x7f\x80\x00\x00");
+}
+
+// 测试二进制快照
+TEST(TestSnapshot, Snapshot)
+{
+    using namespace SJson;
+    SJson::Json v;
+    std::string bytes;
+    v.Parse("{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1.5,\"abc\",[]],"
+            "\"o\":{\"z\":1,\"y\":2,\"x\":3,\"y\":4},\"\":\"Hello\\u0000World\"}");
+    v.ToSnapshot(bytes);
+
+    SJson::JsonSnapshot snapshot;
+    snapshot.Load(bytes.data(), bytes.size());
+    SJson::JsonSnapshotNode root = snapshot.Root();
+    EXPECT_EQ(JsonType::Object, root.GetType());
+    EXPECT_EQ(8, root.GetObjectSize());
+    EXPECT_EQ("i", root.GetObjectKey(3));
+    EXPECT_EQ(123.0, root.GetObjectValue(3).GetNumber());
+    EXPECT_EQ(JsonType::Null, root.GetObjectValue(root.FindObjectIndex("n")).GetType());
+    EXPECT_EQ(JsonType::False, root.GetObjectValue(root.FindObjectIndex("f")).GetType());
+    EXPECT_EQ(JsonType::True, root.GetObjectValue(root.FindObjectIndex("t")).GetType());
+    EXPECT_EQ("abc", root.GetObjectValue(root.FindObjectIndex("s")).GetString());
+    EXPECT_EQ(std::string("Hello\0World", 11), root.GetObjectValue(root.FindObjectIndex("")).GetString());
+    EXPECT_EQ(-1, root.FindObjectIndex("missing"));
+
+    SJson::JsonSnapshotNode a = root.GetObjectValue(root.FindObjectIndex("a"));
+    EXPECT_EQ(3, a.GetArraySize());
+    EXPECT_EQ(1.5, a.GetArrayElement(0).GetNumber());
+    EXPECT_EQ("abc", a.GetArrayElement(1).GetString());
+    EXPECT_EQ(0, a.GetArrayElement(2).GetArraySize());
+
+    // key 重复时返回第一次出现的位置
+    SJson::JsonSnapshotNode o = root.GetObjectValue(root.FindObjectIndex("o"));
+    EXPECT_EQ(1, o.FindObjectIndex("y"));
+    EXPECT_EQ(2, o.FindObjectIndex("x"));
+    EXPECT_EQ(0, o.FindObjectIndex("z"));
+    EXPECT_EQ(-1, o.FindObjectIndex("w"));
+
+    EXPECT_EQ(1, int(v.GetObjectValue(v.FindObjectIndex("a")) == a.ToJson()));
+
+    // 通过 mmap 打开快照文件
+    const char *path = "snapshot_test.bin";
+    FILE *fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    fwrite(bytes.data(), 1, bytes.size(), fp);
+    fclose(fp);
+    {
+        SJson::JsonSnapshot mapped;
+        mapped.Open(path);
+        EXPECT_EQ("abc", mapped.Root().GetObjectValue(mapped.Root().FindObjectIndex("s")).GetString());
+        SJson::JsonSnapshot moved(std::move(mapped));
+        EXPECT_EQ(8, moved.Root().GetObjectSize());
+    }
+    remove(path);
+
+    // 文件头正确但节点表损坏时也要在加载时拒绝，不能在读取时越界
+    auto corrupt = [&bytes](size_t offset, uint64_t value, size_t width)
+    {
+        std::string damaged = bytes;
+        memcpy(&damaged[offset], &value, width);
+        SJson::JsonSnapshot s;
+        EXPECT_THROW(s.Load(damaged.data(), damaged.size()), SJson::JsonException);
+    };
+    const size_t rootOffset = offsetof(SJson::JsonSnapshotHeader, root);
+    corrupt(rootOffset, 42, sizeof(uint32_t));
+    corrupt(rootOffset + offsetof(SJson::JsonSnapshotEntry, count), UINT32_MAX, sizeof(uint32_t));
+    corrupt(rootOffset + offsetof(SJson::JsonSnapshotEntry, payload), bytes.size(), sizeof(uint64_t));
+    corrupt(rootOffset + offsetof(SJson::JsonSnapshotEntry, payload), UINT64_MAX - 8, sizeof(uint64_t));
+    corrupt(rootOffset + offsetof(SJson::JsonSnapshotEntry, payload), rootOffset, sizeof(uint64_t));
+    SJson::JsonSnapshotEntry rootEntry;
+    memcpy(&rootEntry, &bytes[rootOffset], sizeof(rootEntry));
+    corrupt(rootEntry.payload + offsetof(SJson::JsonSnapshotEntry, type), JsonType::Number, sizeof(uint32_t));
+    corrupt(rootEntry.payload + offsetof(SJson::JsonSnapshotEntry, payload), bytes.size(), sizeof(uint64_t));
+    corrupt(rootEntry.payload + rootEntry.count * 2 * sizeof(SJson::JsonSnapshotEntry), rootEntry.count, sizeof(uint32_t));
+    {
+        // 截断后补上文件头中的长度
+        std::string truncated = bytes.substr(0, bytes.size() / 2);
+        uint64_t size = truncated.size();
+        memcpy(&truncated[offsetof(SJson::JsonSnapshotHeader, size)], &size, sizeof(size));
+        EXPECT_THROW(snapshot.Load(truncated.data(), truncated.size()), SJson::JsonException);
+    }
+
+    bytes[0] = 'X';
+    EXPECT_THROW(snapshot.Load(bytes.data(), bytes.size()), SJson::JsonException);
+    EXPECT_THROW(snapshot.Load(bytes.data(), 8), SJson::JsonException);
+    EXPECT_THROW(snapshot.Open("no_such_snapshot.bin"), SJson::JsonException);
+}
+
+// 测试磁带格式的只读文档
+TEST(TestTape, Tape)
+{
+    using namespace SJson;
+    SJson::JsonTape tape;
+    const char *content = "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1.5,\"Hello\\u0000World\",[],{}],"
+                          "\"o\":{\"1\":1,\"2\":[2],\"3\":3}}";
+    tape.Parse(content, status);
+    EXPECT_EQ("parse ok", status);
+    SJson::JsonTapeNode root = tape.Root();
+    EXPECT_EQ(JsonType::Object, root.GetType());
+    EXPECT_EQ(7, root.GetObjectSize());
+    EXPECT_EQ("s", root.GetObjectKey(4));
+    EXPECT_EQ("abc", root.GetObjectValue(4).GetString());
+    EXPECT_EQ(JsonType::Null, root.GetObjectValue(root.FindObjectIndex("n")).GetType());
+    EXPECT_EQ(JsonType::False, root.GetObjectValue(root.FindObjectIndex("f")).GetType());
+    EXPECT_EQ(JsonType::True, root.GetObjectValue(root.FindObjectIndex("t")).GetType());
+    EXPECT_EQ(123.0, root.GetObjectValue(root.FindObjectIndex("i")).GetNumber());
+    EXPECT_EQ(-1, root.FindObjectIndex("x"));
+
+    SJson::JsonTapeNode a = root.GetObjectValue(root.FindObjectIndex("a"));
+    EXPECT_EQ(4, a.GetArraySize());
+    EXPECT_EQ(1.5, a.GetArrayElement(0).GetNumber());
+    EXPECT_EQ(std::string("Hello\0World", 11), a.GetArrayElement(1).GetString());
+    EXPECT_EQ(0, a.GetArrayElement(2).GetArraySize());
+    EXPECT_TRUE(a.GetArrayElement(2).First().IsEnd());
+    EXPECT_EQ(0, a.GetArrayElement(3).GetObjectSize());
+
+    // 顺序遍历，跳过子树
+    size_t count = 0;
+    for (SJson::JsonTapeNode it = root.First(); !it.IsEnd(); it = it.Next().Next())
+        ++count;
+    EXPECT_EQ(7, count);
+
+    SJson::Json expect;
+    expect.Parse(content);
+    EXPECT_EQ(1, int(expect == root.ToJson()));
+
+    // 大数组的元素个数超出开始标记能记录的范围时仍然正确
+    std::string big = "[";
+    for (int i = 0; i < 0x1000000 + 3; ++i)
+        big += i ? ",0" : "0";
+    big += ']';
+    tape.Parse(big);
+    EXPECT_EQ(0x1000000 + 3, tape.Root().GetArraySize());
+
+    tape.Parse("[1,]", status);
+    EXPECT_EQ("parse invalid value", status);
+    tape.Parse("{\"a\":1", status);
+    EXPECT_EQ("parse miss comma or curly bracket", status);
+    tape.Parse("{1:1}", status);
+    EXPECT_EQ("parse miss key", status);
+    tape.Parse("[1 2", status);
+    EXPECT_EQ("parse miss comma or square bracket", status);
+    tape.Parse("null x", status);
+    EXPECT_EQ("parse root not singular", status);
+}
+
+#define test_pointer(expect, path)                     \
+    do                                                 \
+    {                                                  \
+        std::string out;                               \
+        v.At(SJson::JsonPointer(path)).Stringify(out); \
+        EXPECT_EQ(expect, out);                        \
+    } while (0)
+
+// 测试 JSON Pointer（RFC 6901）
+TEST(TestPointer, Pointer)
+{
+    SJson::Json v;
+    v.Parse("{\"foo\":[\"bar\",\"baz\"],\"\":0,\"a/b\":1,\"c%d\":2,\"e^f\":3,\"g|h\":4,\"i\\\\j\":5,"
+            "\"k\\\"l\":6,\" \":7,\"m~n\":8,\"o\":{\"p\":[{\"q\":true}]}}");
+    test_pointer("[\"bar\",\"baz\"]", "/foo");
+    test_pointer("\"bar\"", "/foo/0");
+    test_pointer("0", "/");
+    test_pointer("1", "/a~1b");
+    test_pointer("2", "/c%d");
+    test_pointer("3", "/e^f");
+    test_pointer("4", "/g|h");
+    test_pointer("5", "/i\\j");
+    test_pointer("6", "/k\"l");
+    test_pointer("7", "/ ");
+    test_pointer("8", "/m~0n");
+    test_pointer("true", "/o/p/0/q");
+
+    std::string all, out;
+    v.Stringify(all);
+    v.At(SJson::JsonPointer("")).Stringify(out);
+    EXPECT_EQ(all, out);
+
+    // 编译一次后在多个文档上重复使用
+    SJson::JsonPointer ptr("/o/p/0/q");
+    EXPECT_EQ(4, ptr.GetTokenSize());
+    EXPECT_EQ("p", ptr.GetToken(1));
+    EXPECT_EQ("/a~1b/m~0n", SJson::JsonPointer("/a~1b/m~0n").ToString());
+    SJson::Json w;
+    w.Parse("{\"o\":{\"p\":[{\"q\":false}]}}");
+    EXPECT_EQ(SJson::JsonType::False, w.At(ptr).GetType());
+
+    // 找不到的路径
+    EXPECT_FALSE(v.Find(SJson::JsonPointer("/foo/2")).IsValid());
+    EXPECT_FALSE(v.Find(SJson::JsonPointer("/foo/-")).IsValid());
+    EXPECT_FALSE(v.Find(SJson::JsonPointer("/foo/01")).IsValid());
+    EXPECT_FALSE(v.Find(SJson::JsonPointer("/foo/0/x")).IsValid());
+    EXPECT_FALSE(v.Find(SJson::JsonPointer("/x")).IsValid());
+    EXPECT_THROW(v.At(SJson::JsonPointer("/x")), SJson::JsonException);
+
+    // 语法错误
+    EXPECT_THROW(SJson::JsonPointer("foo"), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPointer("/~2"), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPointer("/a~"), SJson::JsonException);
+
+    // key 较多的对象使用哈希表查找，重复的 key 返回第一个
+    SJson::Json big;
+    big.SetObject();
+    for (int i = 0; i < 100; ++i)
+        big.SetObjectValue(std::to_string(i), SJson::Json());
+    SJson::Json n;
+    n.SetNumber(1);
+    big.SetObjectValue("50", n);
+    EXPECT_EQ(100, big.GetObjectSize());
+    EXPECT_EQ(1.0, big.At(SJson::JsonPointer("/50")).GetNumber());
+    EXPECT_EQ(99, big.FindObjectIndex("99"));
+    EXPECT_EQ(-1, big.FindObjectIndex("100"));
+    big.Parse("{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,\"a\":9}");
+    EXPECT_EQ(0, big.FindObjectIndex("a"));
+    EXPECT_EQ(7, big.FindObjectIndex("h"));
+
+    // 视图拷贝出独立的 Json
+    SJson::Json copy = v.At(SJson::JsonPointer("/foo")).ToJson();
+    EXPECT_EQ(2, copy.GetArraySize());
+    EXPECT_EQ("baz", copy.GetArrayElement(1).GetString());
+}
+
+#define test_path(expect, json, expr)                     \
+    do                                                    \
+    {                                                     \
+        SJson::Json v;                                    \
+        v.Parse(json, status);                            \
+        EXPECT_EQ("parse ok", status);                    \
+        std::string out = "[";                            \
+        for (auto &view : v.Query(SJson::JsonPath(expr))) \
+        {                                                 \
+            std::string s;                                \
+            view.Stringify(s);                            \
+            out += (out.size() > 1 ? "," : "") + s;       \
+        }                                                 \
+        EXPECT_EQ(expect "", out + "]");                  \
+    } while (0)
+
+// 测试 JSONPath 查询
+TEST(TestPath, Path)
+{
+    const char *store = "{\"store\":{\"book\":["
+                        "{\"category\":\"reference\",\"author\":\"Nigel Rees\",\"title\":\"Sayings of the Century\",\"price\":8.95},"
+                        "{\"category\":\"fiction\",\"author\":\"Evelyn Waugh\",\"title\":\"Sword of Honour\",\"price\":12.99},"
+                        "{\"category\":\"fiction\",\"author\":\"Herman Melville\",\"title\":\"Moby Dick\",\"isbn\":\"0-553-21311-3\",\"price\":8.99},"
+                        "{\"category\":\"fiction\",\"author\":\"J. R. R. Tolkien\",\"title\":\"The Lord of the Rings\",\"isbn\":\"0-395-19395-8\",\"price\":22.99}],"
+                        "\"bicycle\":{\"color\":\"red\",\"price\":399}}}";
+    test_path("[\"Nigel Rees\",\"Evelyn Waugh\",\"Herman Melville\",\"J. R. R. Tolkien\"]", store, "$.store.book[*].author");
+    test_path("[\"Nigel Rees\",\"Evelyn Waugh\",\"Herman Melville\",\"J. R. R. Tolkien\"]", store, "$..author");
+    test_path("[3,1,2]", "{\"a\":{\"p\":1,\"b\":[{\"p\":2}]},\"p\":3}", "$..p");
+    test_path("[\"Moby Dick\"]", store, "$..book[2].title");
+    test_path("[\"The Lord of the Rings\"]", store, "$..book[-1].title");
+    test_path("[\"Sayings of the Century\",\"Sword of Honour\"]", store, "$..book[:2].title");
+    test_path("[\"Sayings of the Century\",\"Moby Dick\"]", store, "$..book[0,2].title");
+    test_path("[\"Moby Dick\",\"The Lord of the Rings\"]", store, "$..book[?(@.isbn)].title");
+    test_path("[\"Sayings of the Century\",\"Moby Dick\"]", store, "$..book[?(@.price < 10)].title");
+    test_path("[\"Sword of Honour\",\"The Lord of the Rings\"]", store, "$.store.book[?(@.price > 10)].title");
+    test_path("[\"Moby Dick\"]", store, "$..book[?(@.price < 10 && @.category == 'fiction')].title");
+    test_path("[\"Sayings of the Century\",\"The Lord of the Rings\"]", store, "$..book[?(!(@.category == \"fiction\") || @.price >= 22.99)].title");
+    test_path("[\"red\"]", store, "$['store'][\"bicycle\"].color");
+    test_path("[]", store, "$.store.book[?(@.price > $.store.bicycle.price)]");
+
+    test_path("[1,2,3]", "[0,1,2,3,4]", "$[1:4]");
+    test_path("[0,2,4]", "[0,1,2,3,4]", "$[::2]");
+    test_path("[4,3,2,1,0]", "[0,1,2,3,4]", "$[::-1]");
+    test_path("[3,4]", "[0,1,2,3,4]", "$[-2:]");
+    test_path("[]", "[0,1,2,3,4]", "$[5]");
+    test_path("[]", "[0,1,2,3,4]", "$[::0]");
+    test_path("[[0,1]]", "[0,1]", "$");
+    test_path("[1,\"x\"]", "{\"a\":1,\"b\":\"x\"}", "$.*");
+    test_path("[{\"a b\":1}]", "[{\"a b\":1},{\"a b\":2}]", "$[?@['a b'] == 1]");
+    test_path("[null]", "[null,true,false]", "$[?@ == null]");
+
+    // 编译一次，重复执行
+    SJson::JsonPath path("$.a[?(@.v >= 2)].v");
+    SJson::Json v1, v2;
+    v1.Parse("{\"a\":[{\"v\":1},{\"v\":2},{\"v\":3}]}");
+    v2.Parse("{\"a\":[{\"v\":5}]}");
+    EXPECT_EQ(2, v1.Query(path).size());
+    EXPECT_EQ(1, v2.Query(path).size());
+    EXPECT_EQ(5.0, v2.Query(path)[0].GetNumber());
+
+    EXPECT_THROW(SJson::JsonPath("a.b"), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPath("$."), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPath("$[1"), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPath("$['a]"), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPath("$[?(@.a > )]"), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPath("$[?(@..a == 1)]"), SJson::JsonException);
+    EXPECT_THROW(SJson::JsonPath("$[?(1)]"), SJson::JsonException);
+}
+
+#define test_patch(expect, doc, patch) \
+    do                                 \
+    {                                  \
+        SJson::Json v, p, e;           \
+        v.Parse(doc);                  \
+        p.Parse(patch);                \
+        e.Parse(expect);               \
+        v.Patch(p, status);            \
+        EXPECT_EQ("patch ok", status); \
+        EXPECT_EQ(1, int(v == e));     \
+    } while (0)
+
+#define test_patch_error(error, doc, patch) \
+    do                                      \
+    {                                       \
+        SJson::Json v, p, e;                \
+        v.Parse(doc);                       \
+        p.Parse(patch);                     \
+        e.Parse(doc);                       \
+        v.Patch(p, status);                 \
+        EXPECT_EQ(error, status);           \
+        EXPECT_EQ(1, int(v == e));          \
+    } while (0)
+
+// 测试 JSON Patch（RFC 6902 附录 A 中的例子）
+TEST(TestPatch, Patch)
+{
+    test_patch("{\"baz\":\"qux\",\"foo\":\"bar\"}", "{\"foo\":\"bar\"}", "[{\"op\":\"add\",\"path\":\"/baz\",\"value\":\"qux\"}]");
+    test_patch("{\"foo\":[\"bar\",\"qux\",\"baz\"]}", "{\"foo\":[\"bar\",\"baz\"]}", "[{\"op\":\"add\",\"path\":\"/foo/1\",\"value\":\"qux\"}]");
+    test_patch("{\"foo\":\"bar\"}", "{\"baz\":\"qux\",\"foo\":\"bar\"}", "[{\"op\":\"remove\",\"path\":\"/baz\"}]");
+    test_patch("{\"foo\":[\"bar\",\"baz\"]}", "{\"foo\":[\"bar\",\"qux\",\"baz\"]}", "[{\"op\":\"remove\",\"path\":\"/foo/1\"}]");
+    test_patch("{\"baz\":\"boo\",\"foo\":\"bar\"}", "{\"baz\":\"qux\",\"foo\":\"bar\"}", "[{\"op\":\"replace\",\"path\":\"/baz\",\"value\":\"boo\"}]");
+    test_patch("{\"foo\":{\"bar\":\"baz\"},\"qux\":{\"corge\":\"grault\",\"thud\":\"fred\"}}",
+               "{\"foo\":{\"bar\":\"baz\",\"waldo\":\"fred\"},\"qux\":{\"corge\":\"grault\"}}",
+               "[{\"op\":\"move\",\"from\":\"/foo/waldo\",\"path\":\"/qux/thud\"}]");
+    test_patch("{\"foo\":[\"all\",\"cows\",\"eat\",\"grass\"]}", "{\"foo\":[\"all\",\"grass\",\"cows\",\"eat\"]}",
+               "[{\"op\":\"move\",\"from\":\"/foo/1\",\"path\":\"/foo/3\"}]");
+    test_patch("{\"baz\":\"qux\",\"foo\":[\"a\",2,\"c\"]}", "{\"baz\":\"qux\",\"foo\":[\"a\",2,\"c\"]}",
+               "[{\"op\":\"test\",\"path\":\"/baz\",\"value\":\"qux\"},{\"op\":\"test\",\"path\":\"/foo/1\",\"value\":2}]");
+    test_patch("{\"foo\":\"bar\",\"child\":{\"grandchild\":{}}}", "{\"foo\":\"bar\"}", "[{\"op\":\"add\",\"path\":\"/child\",\"value\":{\"grandchild\":{}}}]");
+    test_patch("{\"foo\":[\"bar\",[\"abc\",\"def\"]]}", "{\"foo\":[\"bar\"]}", "[{\"op\":\"add\",\"path\":\"/foo/-\",\"value\":[\"abc\",\"def\"]}]");
+    test_patch("{\"a\":[1,2],\"b\":[1,2]}", "{\"a\":[1,2]}", "[{\"op\":\"copy\",\"from\":\"/a\",\"path\":\"/b\"}]");
+    test_patch("[1]", "{\"a\":[1]}", "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"\"}]");
+    test_patch("{\"x\":1}", "[1]", "[{\"op\":\"replace\",\"path\":\"\",\"value\":{\"x\":1}}]");
+    test_patch("{\"a\":1}", "{\"a\":1}", "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/a\"}]");
+
+    // 失败时已经应用的操作全部撤销，文档保持不变
+    test_patch_error("patch test failed", "{\"baz\":\"qux\"}", "[{\"op\":\"test\",\"path\":\"/baz\",\"value\":\"bar\"}]");
+    test_patch_error("patch path not found", "{\"foo\":\"bar\"}", "[{\"op\":\"add\",\"path\":\"/baz/bat\",\"value\":\"qux\"}]");
+    test_patch_error("patch path not found", "[1,2]", "[{\"op\":\"add\",\"path\":\"/3\",\"value\":3}]");
+    test_patch_error("patch invalid path", "{\"a\":{\"b\":1}}", "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/a/b\"}]");
+    // 移动与复制的目标不存在时，被移走的值放回原处
+    test_patch_error("patch path not found", "{\"a\":1,\"b\":[1,2]}", "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/x/y\"}]");
+    test_patch_error("patch path not found", "{\"b\":[1,2]}", "[{\"op\":\"move\",\"from\":\"/b/0\",\"path\":\"/b/5\"}]");
+    test_patch_error("patch path not found", "{\"a\":{\"c\":[1]},\"b\":[1,2]}",
+                     "[{\"op\":\"move\",\"from\":\"/b/0\",\"path\":\"/a/c/1\"},{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/b/9\"}]");
+    // 移动到原来的位置时 from 也必须存在
+    test_patch_error("patch path not found", "{\"a\":1}", "[{\"op\":\"move\",\"from\":\"/b\",\"path\":\"/b\"}]");
+    test_patch_error("patch path not found", "{\"a\":[1]}", "[{\"op\":\"move\",\"from\":\"/a/1\",\"path\":\"/a/1\"}]");
+    test_patch_error("patch path not found", "{\"a\":1,\"b\":[1,2]}", "[{\"op\":\"copy\",\"from\":\"/a\",\"path\":\"/x/y\"}]");
+    test_patch_error("patch path not found", "{\"a\":1,\"b\":[1,2]}", "[{\"op\":\"copy\",\"from\":\"/b/1\",\"path\":\"/b/7\"}]");
+    test_patch_error("patch invalid operation", "{}", "[{\"op\":\"foo\",\"path\":\"/a\"}]");
+    test_patch_error("patch invalid operation", "{}", "[{\"op\":\"add\",\"path\":\"/a\"}]");
+    test_patch_error("patch test failed", "{\"a\":[1,2,3],\"b\":{\"c\":1},\"d\":0}",
+                     "[{\"op\":\"remove\",\"path\":\"/a/0\"},{\"op\":\"move\",\"from\":\"/b/c\",\"path\":\"/a/0\"},"
+                     "{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/d\"},{\"op\":\"add\",\"path\":\"/e\",\"value\":[]},"
+                     "{\"op\":\"copy\",\"from\":\"/d\",\"path\":\"/e/0\"},{\"op\":\"replace\",\"path\":\"\",\"value\":null},"
+                     "{\"op\":\"test\",\"path\":\"\",\"value\":1}]");
+
+    // 修改后的子树不再使用过期的序列化缓存
+    SJson::Json v, p;
+    v.Parse("{\"a\":{\"b\":[\"0123456789012345678901234567890123456789012345678901234567890123456789\"]}}");
+    std::string before, after;
+    v.Stringify(before, SJson::StringifyFlag::Cache);
+    p.Parse("[{\"op\":\"add\",\"path\":\"/a/b/-\",\"value\":1}]");
+    v.Patch(p);
+    v.Stringify(after, SJson::StringifyFlag::Cache);
+    EXPECT_EQ(before.substr(0, before.size() - 3) + ",1]}}", after);
+}
+
+#define test_merge_patch(expect, doc, patch) \
+    do                                       \
+    {                                        \
+        SJson::Json v, p;                    \
+        v.Parse(doc);                        \
+        p.Parse(patch);                      \
+        v.MergePatch(p);                     \
+        std::string out;                     \
+        v.Stringify(out);                    \
+        EXPECT_EQ(expect, out);              \
+    } while (0)
+
+// 测试 JSON Merge Patch（RFC 7386 附录 A 中的例子）
+TEST(TestMergePatch, MergePatch)
+{
+    test_merge_patch("{\"a\":\"c\"}", "{\"a\":\"b\"}", "{\"a\":\"c\"}");
+    test_merge_patch("{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":\"b\"}", "{\"b\":\"c\"}");
+    test_merge_patch("{}", "{\"a\":\"b\"}", "{\"a\":null}");
+    test_merge_patch("{\"b\":\"c\"}", "{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}");
+    test_merge_patch("{\"a\":\"c\"}", "{\"a\":[\"b\"]}", "{\"a\":\"c\"}");
+    test_merge_patch("{\"a\":[\"b\"]}", "{\"a\":\"c\"}", "{\"a\":[\"b\"]}");
+    test_merge_patch("{\"a\":{\"b\":\"d\"}}", "{\"a\":{\"b\":\"c\"}}", "{\"a\":{\"b\":\"d\",\"c\":null}}");
+    test_merge_patch("{\"a\":[1]}", "{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}");
+    test_merge_patch("[\"c\",\"d\"]", "[\"a\",\"b\"]", "[\"c\",\"d\"]");
+    test_merge_patch("[\"c\"]", "{\"a\":\"b\"}", "[\"c\"]");
+    test_merge_patch("null", "{\"a\":\"foo\"}", "null");
+    test_merge_patch("\"bar\"", "{\"a\":\"foo\"}", "\"bar\"");
+    test_merge_patch("{\"e\":null,\"a\":1}", "{\"e\":null}", "{\"a\":1}");
+    test_merge_patch("{\"a\":{\"bb\":{}}}", "[1,2]", "{\"a\":{\"bb\":{\"ccc\":null}}}");
+}
+
+#define test_diff(expect, source, target) \
+    do                                    \
+    {                                     \
+        SJson::Json a, b;                 \
+        a.Parse(source);                  \
+        b.Parse(target);                  \
+        SJson::Json patch = a.Diff(b);    \
+        std::string out;                  \
+        patch.Stringify(out);             \
+        EXPECT_EQ(expect, out);           \
+        a.Patch(patch);                   \
+        EXPECT_EQ(1, int(a == b));        \
+    } while (0)
+
+// 测试生成 JSON Patch
+TEST(TestDiff, Diff)
+{
+    test_diff("[]", "{\"a\":[1,2,{\"b\":null}]}", "{\"a\":[1,2,{\"b\":null}]}");
+    test_diff("[]", "{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":1}");
+    test_diff("[{\"op\":\"replace\",\"path\":\"\",\"value\":[1]}]", "1", "[1]");
+    test_diff("[{\"op\":\"replace\",\"path\":\"/a\",\"value\":2}]", "{\"a\":1}", "{\"a\":2}");
+    test_diff("[{\"op\":\"remove\",\"path\":\"/a\"},{\"op\":\"add\",\"path\":\"/b\",\"value\":1}]", "{\"a\":1}", "{\"b\":1}");
+    test_diff("[{\"op\":\"add\",\"path\":\"/a~1b~0\",\"value\":true}]", "{}", "{\"a/b~\":true}");
+    test_diff("[{\"op\":\"replace\",\"path\":\"/x/y/1\",\"value\":\"B\"}]", "{\"x\":{\"y\":[\"a\",\"b\",\"c\"]}}", "{\"x\":{\"y\":[\"a\",\"B\",\"c\"]}}");
+    test_diff("[{\"op\":\"add\",\"path\":\"/2\",\"value\":9}]", "[1,2,3,4]", "[1,2,9,3,4]");
+    test_diff("[{\"op\":\"remove\",\"path\":\"/1\"}]", "[1,2,3,4]", "[1,3,4]");
+    test_diff("[{\"op\":\"remove\",\"path\":\"/0\"},{\"op\":\"add\",\"path\":\"/3\",\"value\":5}]", "[1,2,3,4]", "[2,3,4,5]");
+    test_diff("[{\"op\":\"replace\",\"path\":\"/1/v\",\"value\":3},{\"op\":\"add\",\"path\":\"/2\",\"value\":{\"v\":4}}]",
+              "[{\"v\":1},{\"v\":2}]", "[{\"v\":1},{\"v\":3},{\"v\":4}]");
+
+    // 大数组按位置对齐
+    std::string big1 = "[", big2 = "[";
+    for (int i = 0; i < 3000; ++i)
+    {
+        big1 += (i ? "," : "") + std::to_string(i);
+        big2 += (i ? "," : "") + std::to_string(i % 7 ? i : -i);
+    }
+    SJson::Json a, b;
+    a.Parse(big1 + "]");
+    b.Parse(big2 + ",1]");
+    a.Patch(a.Diff(b));
+    EXPECT_EQ(1, int(a == b));
+
+    // 相等的值哈希相同，与对象 key 的顺序无关
+    a.Parse("{\"a\":[1,{\"b\":0}],\"c\":\"d\"}");
+    b.Parse("{\"c\":\"d\",\"a\":[1,{\"b\":-0}]}");
+    EXPECT_EQ(a.Diff(b).GetArraySize(), 0);
+}
+
 #define test_equal(json1, json2, equality)  \
     do                                      \
     {                                       \
@@ -443,6 +1210,51 @@ TEST(TestEqual, Equal)
     test_equal("{\"a\":1,\"b\":2}", "{\"a\":1,\"b\":2,\"c\":3}", 0);
     test_equal("{\"a\":{\"b\":{\"c\":{}}}}", "{\"a\":{\"b\":{\"c\":{}}}}", 1);
     test_equal("{\"a\":{\"b\":{\"c\":{}}}}", "{\"a\":{\"b\":{\"c\":[]}}}", 0);
+    // 重复的 key：每个键值对只能匹配一次
+    test_equal("{\"a\":1,\"a\":2}", "{\"a\":2,\"a\":1}", 1);
+    test_equal("{\"a\":1,\"a\":1}", "{\"a\":1,\"a\":7}", 0);
+    test_equal("{\"a\":1,\"a\":7}", "{\"a\":1,\"a\":1}", 0);
+}
+
+// 测试哈希：相等的值哈希相同，可以作为 unordered_set 的 key
+TEST(TestHash, Hash)
+{
+    SJson::Json v1, v2, v3;
+    v1.Parse("{\"a\":[1,2,{\"x\":null}],\"b\":\"s\",\"c\":0}");
+    v2.Parse("{\"c\":-0,\"b\":\"s\",\"a\":[1,2,{\"x\":null}]}");
+    v3.Parse("{\"a\":[2,1,{\"x\":null}],\"b\":\"s\",\"c\":0}");
+    EXPECT_EQ(v1.GetHash(), v2.GetHash());
+    EXPECT_NE(v1.GetHash(), v3.GetHash());
+    EXPECT_EQ(1, int(v1 == v2));
+    EXPECT_EQ(0, int(v1 == v3));
+
+    std::unordered_set<SJson::Json> set;
+    set.insert(v1);
+    set.insert(v2);
+    set.insert(v3);
+    EXPECT_EQ(2, set.size());
+
+    // 修改之后哈希随之更新
+    size_t hash = v1.GetHash();
+    v1.SetObjectValue("d", v3);
+    EXPECT_NE(hash, v1.GetHash());
+    EXPECT_EQ(0, int(v1 == v2));
+    v1.RemoveObjectValue(v1.FindObjectIndex("d"));
+    EXPECT_EQ(hash, v1.GetHash());
+
+    // key 较多的对象
+    std::string big1 = "{", big2 = "{";
+    for (int i = 0; i < 200; ++i)
+    {
+        big1 += (i ? ",\"" : "\"") + std::to_string(i) + "\":" + std::to_string(i);
+        big2 += (i ? ",\"" : "\"") + std::to_string(199 - i) + "\":" + std::to_string(199 - i);
+    }
+    v1.Parse(big1 + "}");
+    v2.Parse(big2 + "}");
+    EXPECT_EQ(1, int(v1 == v2));
+    EXPECT_EQ(v1.GetHash(), v2.GetHash());
+    v2.Parse(big2 + ",\"0\":1}");
+    EXPECT_EQ(0, int(v1 == v2));
 }
 
 // 测试是否拷贝
@@ -454,6 +1266,687 @@ TEST(TestCopy, Copy)
     EXPECT_EQ(1, int(v2 == v1));
 }
 
+// 测试写时复制：拷贝共享数据，修改其中一个不影响其他的拷贝
+TEST(TestCopyOnWrite, CopyOnWrite)
+{
+    SJson::Json v1, v2, v3, p;
+    std::string s1, s2, s3;
+    v1.Parse("{\"a\":{\"b\":[1,2,{\"c\":3}]},\"d\":[4]}");
+    v2 = v1;
+    v3 = v1.GetObjectValue(0);
+
+    p.Parse("[{\"op\":\"replace\",\"path\":\"/a/b/2/c\",\"value\":30}]");
+    v2.Patch(p);
+    v2.SetObjectValue("e", v3);
+    SJson::Json arr = v1.GetObjectValue(1);
+    arr.PushbackArrayElement(v3);
+
+    v1.Stringify(s1);
+    v2.Stringify(s2);
+    v3.Stringify(s3);
+    EXPECT_EQ("{\"a\":{\"b\":[1,2,{\"c\":3}]},\"d\":[4]}", s1);
+    EXPECT_EQ("{\"a\":{\"b\":[1,2,{\"c\":30}]},\"d\":[4],\"e\":{\"b\":[1,2,{\"c\":3}]}}", s2);
+    EXPECT_EQ("{\"b\":[1,2,{\"c\":3}]}", s3);
+    EXPECT_EQ(2, arr.GetArraySize());
+    EXPECT_EQ(1, v1.GetObjectValue(1).GetArraySize());
+
+    // 修改数组元素和对象成员
+    SJson::Json a2 = arr;
+    a2.EraseArrayElement(0, 1);
+    a2.InsertArrayElement(v1, 0);
+    a2.PopbackArrayElement();
+    EXPECT_EQ(2, arr.GetArraySize());
+    EXPECT_EQ(1, a2.GetArraySize());
+    EXPECT_EQ(1, int(a2.GetArrayElement(0) == v1));
+    SJson::Json o2 = v3;
+    o2.RemoveObjectValue(0);
+    EXPECT_EQ(0, o2.GetObjectSize());
+    EXPECT_EQ(1, v3.GetObjectSize());
+
+    // 插入自身时插入的是插入前的值，不会引用自己的存储
+    SJson::Json self;
+    self.Parse("[1]");
+    self.PushbackArrayElement(self);
+    self.InsertArrayElement(self, 0);
+    self.Stringify(s1);
+    EXPECT_EQ("[[1,[1]],1,[1]]", s1);
+    self.Parse("{\"a\":1}");
+    self.SetObjectValue("self", self);
+    self.Stringify(s1);
+    EXPECT_EQ("{\"a\":1,\"self\":{\"a\":1}}", s1);
+    self.SetObjectValue("self", self);
+    self.Stringify(s1);
+    EXPECT_EQ("{\"a\":1,\"self\":{\"a\":1,\"self\":{\"a\":1}}}", s1);
+}
+
+// 测试在两个线程中分别读取原值（填充缓存）和修改它的拷贝
+TEST(TestCopyOnWriteThreads, CopyOnWriteThreads)
+{
+    std::string content = "[";
+    for (int i = 0; i < 2000; ++i)
+        content += std::string(i ? "," : "") + "{\"a\":[1,\"x\",{\"b\":" + std::to_string(i) + "}],\"s\":\"v" + std::to_string(i) + "\"}";
+    content += "]";
+    SJson::Json v, expect;
+    v.Parse(content);
+    expect.Parse(content);
+    const size_t hash = expect.GetHash();
+    std::string cached;
+    std::thread reader([&]()
+                       {
+        for (int k = 0; k < 3; ++k)
+            v.Stringify(cached, SJson::StringifyFlag::Cache);
+        EXPECT_EQ(hash, v.GetHash()); });
+    for (int k = 0; k < 50; ++k)
+    {
+        SJson::Json copy = v;
+        copy.PushbackArrayElement(copy.GetArrayElement(k));
+        copy.GetArrayElement(k).GetHash();
+        EXPECT_EQ(2001, copy.GetArraySize());
+    }
+    reader.join();
+    EXPECT_EQ(content, cached);
+    EXPECT_EQ(2000, v.GetArraySize());
+}
+
+// 测试 key 的 intern：相同的 key 指向同一份字符串
+TEST(TestInternKeys, InternKeys)
+{
+    SJson::Json v1, v2;
+    v1.Parse("[{\"id\":1,\"name\":\"a\"},{\"name\":\"b\",\"id\":2}]");
+    SJson::Json r1 = v1.GetArrayElement(0), r2 = v1.GetArrayElement(1);
+    EXPECT_EQ(&r1.GetObjectKey(0), &r2.GetObjectKey(1));
+    EXPECT_EQ(&r1.GetObjectKey(1), &r2.GetObjectKey(0));
+    EXPECT_EQ(1, r2.FindObjectIndex("id"));
+
+    // 多次解析共享同一张 key 表
+    SJson::JsonKeyTable keys;
+    v1.Parse("{\"id\":1,\"name\":\"a\"}", keys);
+    v2.Parse("{\"id\":2,\"extra\":{\"id\":3}}", status, keys);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ(3, keys.GetSize());
+    EXPECT_EQ(&v1.GetObjectKey(0), &v2.GetObjectKey(0));
+    EXPECT_EQ(&v1.GetObjectKey(0), &v2.GetObjectValue(1).GetObjectKey(0));
+
+    // 表被清空之后，文档中的 key 仍然有效；修改一个文档不影响共享 key 的其他文档
+    keys.Clear();
+    EXPECT_EQ(0, keys.GetSize());
+    v2.SetObjectValue("id", v1);
+    v2.SetObjectValue("more", v1);
+    std::string s1, s2;
+    v1.Stringify(s1);
+    v2.Stringify(s2);
+    EXPECT_EQ("{\"id\":1,\"name\":\"a\"}", s1);
+    EXPECT_EQ("{\"id\":{\"id\":1,\"name\":\"a\"},\"extra\":{\"id\":3},\"more\":{\"id\":1,\"name\":\"a\"}}", s2);
+
+    // 不同来源的 key 内容相同时仍然相等
+    SJson::Json v3;
+    v3.SetObject();
+    v3.SetObjectValue("name", SJson::Json());
+    v3.SetObjectValue("id", SJson::Json());
+    v1.SetObjectValue("id", SJson::Json());
+    v1.SetObjectValue("name", SJson::Json());
+    EXPECT_EQ(1, int(v1 == v3));
+    EXPECT_EQ(v1.GetHash(), v3.GetHash());
+}
+
+// 测试 key 序列相同的对象共享 shape：修改其中一个对象的 key 不影响其他对象
+TEST(TestShape, Shape)
+{
+    SJson::Json v, r0, r1, r2;
+    std::string s;
+    v.Parse("[{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8},"
+            "{\"a\":9,\"b\":10,\"c\":11,\"d\":12,\"e\":13,\"f\":14,\"g\":15,\"h\":16},"
+            "{\"h\":0,\"b\":0,\"c\":0,\"d\":0,\"e\":0,\"f\":0,\"g\":0,\"a\":0}]");
+    r0 = v.GetArrayElement(0);
+    r1 = v.GetArrayElement(1);
+    r2 = v.GetArrayElement(2);
+    EXPECT_EQ(6, r0.FindObjectIndex("g"));
+    EXPECT_EQ(6, r1.FindObjectIndex("g"));
+    EXPECT_EQ(7, r2.FindObjectIndex("a"));
+    EXPECT_EQ(-1, r1.FindObjectIndex("x"));
+    EXPECT_EQ(1, int(r0 != r1));
+
+    r1.SetObjectValue("x", SJson::Json());
+    r1.SetObjectValue("a", r0.GetObjectValue(1));
+    r1.RemoveObjectValue(1);
+    EXPECT_EQ(7, r1.FindObjectIndex("x"));
+    EXPECT_EQ(-1, r1.FindObjectIndex("b"));
+    EXPECT_EQ(1, r0.FindObjectIndex("b"));
+    EXPECT_EQ(-1, r0.FindObjectIndex("x"));
+    r1.Stringify(s);
+    EXPECT_EQ("{\"a\":2,\"c\":11,\"d\":12,\"e\":13,\"f\":14,\"g\":15,\"h\":16,\"x\":null}", s);
+    v.Stringify(s);
+    EXPECT_EQ("[{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8},"
+              "{\"a\":9,\"b\":10,\"c\":11,\"d\":12,\"e\":13,\"f\":14,\"g\":15,\"h\":16},"
+              "{\"h\":0,\"b\":0,\"c\":0,\"d\":0,\"e\":0,\"f\":0,\"g\":0,\"a\":0}]",
+              s);
+
+    // 相同 shape 的对象按位置比较，不同 shape 的对象按 key 比较
+    SJson::Json w;
+    w.Parse("[{\"a\":1,\"b\":[2]},{\"a\":1,\"b\":[2]},{\"b\":[2],\"a\":1},{}]");
+    EXPECT_EQ(1, int(w.GetArrayElement(0) == w.GetArrayElement(1)));
+    EXPECT_EQ(1, int(w.GetArrayElement(0) == w.GetArrayElement(2)));
+    SJson::Json e = w.GetArrayElement(3);
+    e.SetObjectValue("a", SJson::Json());
+    EXPECT_EQ(1, e.GetObjectSize());
+    EXPECT_EQ(0, w.GetArrayElement(3).GetObjectSize());
+    e.ClearObject();
+    EXPECT_EQ(-1, e.FindObjectIndex("a"));
+}
+
+// 测试全部是数字的数组：紧凑保存之后读取、比较、修改的结果与普通数组相同
+TEST(TestPackedArray, PackedArray)
+{
+    SJson::Json v, built, copy;
+    std::string s;
+    v.Parse("[1.5, -0, 3, 1e10]");
+    // 逐个添加元素得到的是普通数组
+    built.SetArray();
+    for (double d : {1.5, 0.0, 3.0, 1e10})
+    {
+        SJson::Json n;
+        n.SetNumber(d);
+        built.PushbackArrayElement(n);
+    }
+    EXPECT_EQ(4, v.GetArraySize());
+    EXPECT_DOUBLE_EQ(3.0, v.GetArrayElement(2).GetNumber());
+    EXPECT_DOUBLE_EQ(3.0, SJson::JsonView(v).GetArrayElement(2).GetNumber());
+    EXPECT_EQ(1, int(v == built));
+    EXPECT_EQ(1, int(built == v));
+    EXPECT_EQ(v.GetHash(), built.GetHash());
+    v.Stringify(s);
+    EXPECT_EQ("[1.5,-0,3,10000000000]", s);
+
+    // 插入数字之后仍然是数字数组，插入其他类型的值之后转换为普通数组，拷贝不受影响
+    copy = v;
+    SJson::Json n, str;
+    n.SetNumber(7);
+    str.SetString("x");
+    v.InsertArrayElement(n, 0);
+    v.PushbackArrayElement(v.GetArrayElement(0));
+    v.EraseArrayElement(1, 1);
+    v.Stringify(s);
+    EXPECT_EQ("[7,-0,3,10000000000,7]", s);
+    v.InsertArrayElement(str, 1);
+    v.Stringify(s);
+    EXPECT_EQ("[7,\"x\",-0,3,10000000000,7]", s);
+    EXPECT_EQ(0, int(v == copy));
+    copy.Stringify(s);
+    EXPECT_EQ("[1.5,-0,3,10000000000]", s);
+
+    SJson::Json p;
+    p.Parse("[{\"op\":\"replace\",\"path\":\"/1\",\"value\":[2]},{\"op\":\"test\",\"path\":\"/1/0\",\"value\":2}]");
+    copy.Patch(p);
+    copy.Stringify(s);
+    EXPECT_EQ("[1.5,[2],3,10000000000]", s);
+
+    // 混合数组和编解码
+    SJson::Json mixed, back;
+    mixed.Parse("[1,2,null,[3,4],{\"a\":[5]}]");
+    mixed.Stringify(s);
+    EXPECT_EQ("[1,2,null,[3,4],{\"a\":[5]}]", s);
+    mixed.ToCbor(s);
+    back.ParseCbor(s);
+    EXPECT_EQ(1, int(back == mixed));
+    mixed.ToMsgPack(s);
+    back.ParseMsgPack(s);
+    EXPECT_EQ(1, int(back == mixed));
+}
+
+// 测试一个线程按 JsonValue 读取 packed 数组的元素，另一个线程修改共享存储的拷贝
+TEST(TestPackedArrayThreads, PackedArrayThreads)
+{
+    std::string content = "[";
+    for (int i = 0; i < 1000; ++i)
+        content += std::string(i ? "," : "") + std::to_string(i);
+    content += "]";
+    SJson::Json n;
+    n.Parse(content);
+    std::thread reader([&]()
+                       {
+        for (size_t i = 0; i < n.GetArraySize(); ++i)
+            EXPECT_EQ(double(i), SJson::JsonView(n).GetArrayElement(i).GetNumber()); });
+    for (int k = 0; k < 100; ++k)
+    {
+        SJson::Json n2 = n;
+        SJson::Json e;
+        e.SetNumber(k);
+        n2.PushbackArrayElement(e);
+        EXPECT_EQ(1001, n2.GetArraySize());
+    }
+    reader.join();
+    EXPECT_EQ(1000, n.GetArraySize());
+}
+
+// 测试按列取出对象数组的字段
+TEST(TestColumns, Columns)
+{
+    using namespace SJson;
+    Json v;
+    v.Parse("{\"rows\":[{\"id\":1,\"name\":\"a\",\"ok\":true,\"price\":1.5},"
+            "{\"id\":2,\"name\":\"b\",\"ok\":false,\"price\":2},"
+            "{\"name\":null,\"id\":3,\"price\":\"n/a\"},"
+            "7,"
+            "{\"id\":-4,\"ok\":true,\"extra\":[1]}]}");
+    auto columns = v.At(JsonPointer("/rows")).ExtractColumns({"id", "name", "ok", "price", "missing"});
+    ASSERT_EQ(5, columns.size());
+
+    const JsonColumn &id = columns[0];
+    EXPECT_EQ("id", id.name);
+    EXPECT_EQ(JsonType::Number, id.type);
+    EXPECT_EQ(5, id.numbers.size());
+    ASSERT_EQ(5, id.integers.size());
+    EXPECT_EQ(1, int(id.IsValid(0) && id.IsValid(1) && id.IsValid(2) && !id.IsValid(3) && id.IsValid(4)));
+    EXPECT_EQ(3, id.integers[2]);
+    EXPECT_EQ(-4, id.integers[4]);
+    EXPECT_DOUBLE_EQ(-4.0, id.numbers[4]);
+
+    const JsonColumn &name = columns[1];
+    EXPECT_EQ(JsonType::String, name.type);
+    EXPECT_EQ("b", name.strings[1]);
+    EXPECT_EQ(0, int(name.IsValid(2)));
+    EXPECT_EQ(0, int(name.IsValid(4)));
+
+    const JsonColumn &ok = columns[2];
+    EXPECT_EQ(JsonType::True, ok.type);
+    EXPECT_EQ(1, int(ok.booleans[0]));
+    EXPECT_EQ(0, int(ok.booleans[1]));
+    EXPECT_EQ(1, int(ok.IsValid(1)));
+    EXPECT_EQ(0, int(ok.IsValid(2)));
+
+    // 类型与列不同的行无效，有小数时没有整数形式
+    const JsonColumn &price = columns[3];
+    EXPECT_EQ(JsonType::Number, price.type);
+    EXPECT_EQ(0, int(price.IsValid(2)));
+    EXPECT_DOUBLE_EQ(1.5, price.numbers[0]);
+    EXPECT_EQ(0, price.integers.size());
+
+    EXPECT_EQ(JsonType::Null, columns[4].type);
+    EXPECT_EQ(1, columns[4].validity.size());
+    EXPECT_EQ(0u, columns[4].validity[0]);
+
+    // 全部是数字的数组没有对象
+    Json numbers;
+    numbers.Parse("[1,2,3]");
+    columns = numbers.ExtractColumns({"a"});
+    EXPECT_EQ(0u, columns[0].validity[0]);
+}
+
+// 测试数组中数字的统计与直方图
+TEST(TestAggregate, Aggregate)
+{
+    using namespace SJson;
+    Json v;
+    v.Parse("[3, -1.5, 4, 1, 5, 9, 2, 6]");
+    JsonAggregate agg = v.Aggregate();
+    EXPECT_EQ(8, agg.count);
+    EXPECT_DOUBLE_EQ(28.5, agg.sum);
+    EXPECT_DOUBLE_EQ(-1.5, agg.min);
+    EXPECT_DOUBLE_EQ(9, agg.max);
+    EXPECT_DOUBLE_EQ(28.5 / 8, agg.mean);
+    EXPECT_EQ(std::vector<size_t>({1, 1, 2, 2, 1}), v.Histogram(-2, 8, 5));
+
+    // 非数字的元素被跳过，空数组的结果都是 0
+    v.Parse("[1, \"2\", null, [3], 5]");
+    agg = v.Aggregate();
+    EXPECT_EQ(2, agg.count);
+    EXPECT_DOUBLE_EQ(6, agg.sum);
+    EXPECT_DOUBLE_EQ(1, agg.min);
+    EXPECT_DOUBLE_EQ(5, agg.max);
+    EXPECT_EQ(std::vector<size_t>({1, 1}), v.Histogram(0, 10, 2));
+    v.Parse("[]");
+    agg = v.Aggregate();
+    EXPECT_EQ(0, agg.count);
+    EXPECT_DOUBLE_EQ(0, agg.max);
+    EXPECT_THROW(v.Histogram(1, 1, 4), JsonException);
+    EXPECT_THROW(v.Histogram(0, 1, 0), JsonException);
+    EXPECT_THROW(v.Histogram(0, 5e-324, 10), JsonException);
+
+    // 元素很多时分段计算
+    std::string s = "[";
+    for (int i = 0; i < 300000; ++i)
+        s += std::to_string(i % 1000) + ",";
+    s += "-7]";
+    v.Parse(s);
+    agg = v.Aggregate();
+    EXPECT_EQ(300001, agg.count);
+    EXPECT_DOUBLE_EQ(300.0 * 499500 - 7, agg.sum);
+    EXPECT_DOUBLE_EQ(-7, agg.min);
+    EXPECT_DOUBLE_EQ(999, agg.max);
+    auto hist = v.Histogram(0, 1000, 10);
+    EXPECT_EQ(30000, hist[0]);
+    EXPECT_EQ(30000, hist[9]);
+}
+
+// 测试只检查合法性：结果与解析器一致，另外检查 UTF-8
+TEST(TestValidate, Validate)
+{
+    const char *valid[] = {
+        "null", " true ", "false", "0", "-0.0e+1", "1E-400", "\"\\u00e9\\uD834\\uDD1E\\n\"", "\"\xC3\xA9\xE2\x82\xAC\xF0\x9D\x84\x9E\"",
+        "[]", "{}", "[1,[2,[3,{}]],{\"a\":[]}]", " { \"a\" : 1 , \"b\" : [ null , \"c\" ] } "};
+    for (const char *content : valid)
+    {
+        EXPECT_EQ(true, SJson::Json::Validate(content, strlen(content), status)) << content;
+        EXPECT_EQ("validate ok", status);
+    }
+    // 不合法的文本得到与 Parse 相同的错误信息
+    const char *invalid[] = {
+        "", " ", "nul", "?", "+1", ".1", "1.", "1e", "01", "1e309", "-1e309", "nan", "[1,]", "[\"a\", nul]",
+        "\"abc", "\"\\v\"", "\"\x01\"", "\"\\u12\"", "\"\\uD800\"", "\"\\uD800\\uE000\"",
+        "[1", "[1}", "[1 2", "{1:1}", "{\"a\":1,}", "{\"a\" 1}", "{\"a\":1", "{\"a\":1]", "[[[]]", "null x"};
+    for (const char *content : invalid)
+    {
+        SJson::Json v;
+        std::string expect;
+        v.Parse(content, expect);
+        EXPECT_EQ(false, SJson::Json::Validate(content, strlen(content), status)) << content;
+        EXPECT_EQ(expect, status) << content;
+    }
+    // 长度之外的内容不检查，长度之内的 '\0' 不合法
+    EXPECT_EQ(true, SJson::Json::Validate("[1]garbage", 3));
+    EXPECT_EQ(false, SJson::Json::Validate("[1]\0", 4));
+    EXPECT_EQ(false, SJson::Json::Validate("\"ab", 2));
+
+    // 不合法的 UTF-8：孤立的后续字节、过长编码、代理区、超出范围、截断
+    const char *utf8[] = {"\"\x80\"", "\"\xC0\xAF\"", "\"\xE0\x80\xAF\"", "\"\xED\xA0\x80\"", "\"\xF4\x90\x80\x80\"", "\"\xF8\"", "\"\xE2\x82\"", "{\"\xFF\":1}"};
+    for (const char *content : utf8)
+    {
+        EXPECT_EQ(false, SJson::Json::Validate(content, strlen(content), status)) << content;
+        EXPECT_EQ(content[0] == '{' ? "parse miss key" : "parse invalid utf8", status);
+    }
+
+    // 很深的嵌套不会栈溢出
+    std::string deep(100000, '[');
+    deep += std::string(100000, ']');
+    EXPECT_EQ(true, SJson::Json::Validate(deep.data(), deep.size()));
+    deep.pop_back();
+    EXPECT_EQ(false, SJson::Json::Validate(deep.data(), deep.size()));
+}
+
+// 测试严格 UTF-8 模式：默认原样保留非 ASCII 字节，严格模式拒绝不合法的编码
+TEST(TestStrictUTF8, StrictUTF8)
+{
+    using namespace SJson;
+    SJson::Json v;
+    const char *utf8[] = {"\"\x80\"", "\"\xC0\xAF\"", "\"\xE0\x80\xAF\"", "\"\xED\xA0\x80\"", "\"\xF4\x90\x80\x80\"", "\"\xF8\"", "\"\xE2\x82\"", "[\"a\xE2\x82\"]"};
+    for (const char *content : utf8)
+    {
+        v.Parse(content, status);
+        EXPECT_EQ("parse ok", status) << content;
+        v.Parse(content, status, ParseFlag::StrictUTF8);
+        EXPECT_EQ("parse invalid utf8", status) << content;
+    }
+    v.Parse("{\"\xFF\":1}", status, ParseFlag::StrictUTF8);
+    EXPECT_EQ("parse miss key", status);
+
+    // 合法的多字节字符与转义在严格模式下不受影响
+    v.Parse("\"\xC3\xA9\\u00e9\xE2\x82\xAC\xF0\x9D\x84\x9E\\n\"", status, ParseFlag::StrictUTF8);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ("\xC3\xA9\xC3\xA9\xE2\x82\xAC\xF0\x9D\x84\x9E\n", v.GetString());
+
+    // 跨越多个 16 字节分组的长字符串，特殊字符出现在分组中的不同位置
+    for (size_t len = 0; len < 70; ++len)
+    {
+        std::string text(len, 'x');
+        std::string expect = text + "\xE2\x82\xAC\"" + text;
+        v.Parse("\"" + text + "\xE2\x82\xAC\\\"" + text + "\"", status, ParseFlag::StrictUTF8);
+        EXPECT_EQ("parse ok", status);
+        EXPECT_EQ(expect, v.GetString());
+        EXPECT_EQ(true, Json::Validate(("\"" + text + "\xE2\x82\xAC\"").c_str(), len + 5));
+        v.Parse("\"" + text + "\x01" + text + "\"", status);
+        EXPECT_EQ("parse invalid string char", status);
+        v.Parse("\"" + text, status);
+        EXPECT_EQ("parse miss quotation mark", status);
+        v.Parse("\"" + text + "\xE2\x82" + text + "\"", status, ParseFlag::StrictUTF8);
+        EXPECT_EQ("parse invalid utf8", status);
+    }
+}
+
+// 测试直接去掉空白：字符串内部与数字的写法保持不变
+TEST(TestMinify, Minify)
+{
+    using namespace SJson;
+    std::string content = " {\n\t\"a b\" : [ 1.50 , 1e+2 , -0 ],\r\n  \"c\\\" d\" : \"x \\\\\" , \"\" : { } , \"e\":null } \n";
+    std::string result;
+    EXPECT_EQ(true, Json::Minify(content.data(), content.size(), result));
+    EXPECT_EQ("{\"a b\":[1.50,1e+2,-0],\"c\\\" d\":\"x \\\\\",\"\":{},\"e\":null}", result);
+
+    // 结果与解析后再序列化得到的值相同
+    SJson::Json v1, v2;
+    v1.Parse(content);
+    v2.Parse(result);
+    EXPECT_EQ(true, v1 == v2);
+
+    // 空白和字符串跨越多个 16 字节分组
+    for (size_t len = 0; len < 40; ++len)
+    {
+        std::string pad(len, ' '), text(len, 'x');
+        content = pad + "[" + pad + "\"" + text + " \\\"" + pad + "\"" + pad + "," + text.substr(0, 1) + "true" + pad + "]" + pad;
+        EXPECT_EQ(true, Json::Minify(content.data(), content.size(), result));
+        EXPECT_EQ("[\"" + text + " \\\"" + pad + "\"," + text.substr(0, 1) + "true]", result);
+    }
+
+    // 只在长度之内处理；字符串没有结束时失败
+    EXPECT_EQ(true, Json::Minify("[ 1 ] garbage", 5, result));
+    EXPECT_EQ("[1]", result);
+    EXPECT_EQ(true, Json::Minify("", 0, result));
+    EXPECT_EQ("", result);
+    EXPECT_EQ(false, Json::Minify("[\"abc", 5, result));
+    EXPECT_EQ(false, Json::Minify("[\"abc\\\"]", 8, result));
+    EXPECT_EQ(false, Json::Minify("\"\\", 2, result));
+}
+
+// 测试原样保存的 json 文本：序列化时直接输出，比较与编码使用解析后的值
+TEST(TestRaw, Raw)
+{
+    using namespace SJson;
+    SJson::Json payload, envelope, expect;
+    payload.SetRaw("{ \"b\" : [1.50, 2e0], \"a\" : \"x\" }");
+    EXPECT_EQ(JsonType::Raw, payload.GetType());
+    EXPECT_EQ("{ \"b\" : [1.50, 2e0], \"a\" : \"x\" }", payload.GetRaw());
+    envelope.SetObject();
+    Json id;
+    id.SetNumber(7);
+    envelope.SetObjectValue("id", id);
+    envelope.SetObjectValue("data", payload);
+    std::string content;
+    envelope.Stringify(content);
+    EXPECT_EQ("{\"id\":7,\"data\":{ \"b\" : [1.50, 2e0], \"a\" : \"x\" }}", content);
+    envelope.Stringify(content, StringifyFlag::Canonical);
+    EXPECT_EQ("{\"data\":{\"a\":\"x\",\"b\":[1.5,2]},\"id\":7}", content);
+
+    // 与解析后的值相等，哈希也相同
+    expect.Parse("{\"id\":7,\"data\":{\"a\":\"x\",\"b\":[1.5,2]}}");
+    EXPECT_EQ(true, envelope == expect);
+    EXPECT_EQ(expect.GetHash(), envelope.GetHash());
+    Json other;
+    other.SetRaw("[1]");
+    EXPECT_EQ(false, payload == other);
+
+    // 二进制编码保存解析后的值
+    std::string cbor;
+    envelope.ToCbor(cbor);
+    Json decoded;
+    decoded.ParseCbor(cbor);
+    EXPECT_EQ(JsonType::Object, decoded.GetObjectValue(decoded.FindObjectIndex("data")).GetType());
+    EXPECT_EQ(true, decoded == expect);
+
+    // 快照中多个 Raw 值含有相同的字符串时共用字符串表
+    Json raws, first, second;
+    raws.SetArray();
+    first.SetRaw("{\"k\":\"a long string shared by raw values\"}");
+    second.SetRaw("[\"a long string shared by raw values\",\"k\"]");
+    raws.PushbackArrayElement(first);
+    raws.PushbackArrayElement(second);
+    std::string bytes;
+    raws.ToSnapshot(bytes);
+    JsonSnapshot snapshot;
+    snapshot.Load(bytes.data(), bytes.size());
+    JsonSnapshotNode node = snapshot.Root().GetArrayElement(1);
+    EXPECT_EQ("a long string shared by raw values", node.GetArrayElement(0).GetString());
+    EXPECT_EQ("k", node.GetArrayElement(1).GetString());
+    EXPECT_EQ("k", snapshot.Root().GetArrayElement(0).GetObjectKey(0));
+
+    // 拷贝、移动、视图与重新赋值
+    Json copy = envelope;
+    JsonView view(copy);
+    EXPECT_EQ("{ \"b\" : [1.50, 2e0], \"a\" : \"x\" }", view.GetObjectValue(1).GetRaw());
+    Json moved = std::move(payload);
+    EXPECT_EQ(JsonType::Raw, moved.GetType());
+    moved.SetRaw("null");
+    EXPECT_EQ("null", moved.GetRaw());
+    moved.SetString("s");
+    EXPECT_EQ(JsonType::String, moved.GetType());
+}
+
+// 测试延迟转换的数字：保存原文，读取时才转换，序列化时原样输出
+TEST(TestLazyNumber, LazyNumber)
+{
+    using namespace SJson;
+    SJson::Json v, eager;
+    const std::string content = "{\"price\":19.90,\"big\":12345678901234567890,\"e\":-1.5E+3,\"list\":[0.10,2,3e0]}";
+    v.Parse(content, status, ParseFlag::LazyNumber);
+    EXPECT_EQ("parse ok", status);
+    std::string result;
+    v.Stringify(result);
+    EXPECT_EQ(content, result);
+
+    Json price = v.GetObjectValue(v.FindObjectIndex("price"));
+    EXPECT_EQ("19.90", price.GetNumberText());
+    EXPECT_DOUBLE_EQ(19.9, price.GetNumber());
+    EXPECT_EQ("12345678901234567890", JsonView(v).GetObjectValue(1).GetNumberText());
+    EXPECT_DOUBLE_EQ(-1500, v.GetObjectValue(2).GetNumber());
+
+    // 比较、哈希与规范化输出按数值进行
+    eager.Parse(content);
+    EXPECT_EQ("", eager.GetObjectValue(0).GetNumberText());
+    EXPECT_EQ(true, v == eager);
+    EXPECT_EQ(eager.GetHash(), v.GetHash());
+    std::string canonical;
+    eager.Stringify(canonical, StringifyFlag::Canonical);
+    v.Stringify(result, StringifyFlag::Canonical);
+    EXPECT_EQ(canonical, result);
+    JsonAggregate agg = JsonView(v).GetObjectValue(3).Aggregate();
+    EXPECT_EQ(3, agg.count);
+    EXPECT_DOUBLE_EQ(5.1, agg.sum);
+
+    // 修改之后不再保存原文；插入数组中的数字保留原文
+    price.SetNumber(20);
+    EXPECT_EQ("", price.GetNumberText());
+    Json list;
+    list.Parse("[1.000]", ParseFlag::LazyNumber);
+    Json arr;
+    arr.Parse("[1,2]");
+    arr.PushbackArrayElement(list.GetArrayElement(0));
+    arr.Stringify(result);
+    EXPECT_EQ("[1,2,1.000]", result);
+
+    // 语法与范围检查不变
+    const char *invalid[] = {"01", "1.", "-", "1e", "1e309", "-1e309", "[1,+1]"};
+    for (const char *text : invalid)
+    {
+        std::string expect;
+        eager.Parse(text, expect);
+        v.Parse(text, status, ParseFlag::LazyNumber);
+        EXPECT_EQ(expect, status) << text;
+    }
+    std::string huge(400, '9');
+    v.Parse(huge, status, ParseFlag::LazyNumber);
+    EXPECT_EQ("parse number too big", status);
+    // 边界：308 位整数在 double 范围内，309 位超出范围
+    const std::string boundary[] = {std::string(308, '9'), std::string(309, '9'), "-" + std::string(309, '9'),
+                                    std::string(308, '9') + ".5", "[" + std::string(309, '9') + "]"};
+    for (const std::string &text : boundary)
+    {
+        std::string expect;
+        eager.Parse(text, expect);
+        v.Parse(text, status, ParseFlag::LazyNumber);
+        EXPECT_EQ(expect, status) << text.size();
+    }
+    v.Parse(std::string(309, '9'), status, ParseFlag::LazyNumber);
+    EXPECT_EQ("parse number too big", status);
+}
+
+// 测试解析 json 文本时引用输入中的字符串：没有转义的字符串不拷贝，带转义的字符串第一次读取时才解码
+TEST(TestLazyString, LazyString)
+{
+    using namespace SJson;
+    const std::string content = "{\"plain\":\"hello world\",\"esc\":\"a\\n\\u00e9\\uD834\\uDD1E\\\"\",\"list\":[\"x\\/y\",\"\"]}";
+    SJson::Json v, eager;
+    v.Parse(content, status, ParseFlag::ZeroCopy);
+    EXPECT_EQ("parse ok", status);
+    eager.Parse(content);
+
+    // 没有转义的字符串直接指向输入
+    JsonView view(v);
+    std::string_view plain = view.GetObjectValue(0).GetString();
+    EXPECT_EQ("hello world", plain);
+    EXPECT_EQ(true, plain.data() >= content.data() && plain.data() < content.data() + content.size());
+
+    // 带转义的字符串按原样输出，读取时得到解码后的内容，并且多次读取得到同一份结果
+    std::string result;
+    v.Stringify(result);
+    EXPECT_EQ(content, result);
+    std::string_view esc = view.GetObjectValue(1).GetString();
+    EXPECT_EQ("a\n\xC3\xA9\xF0\x9D\x84\x9E\"", esc);
+    EXPECT_EQ(esc.data(), view.GetObjectValue(1).GetString().data());
+    EXPECT_EQ("x/y", view.GetObjectValue(2).GetArrayElement(0).GetString());
+
+    // 比较、哈希与规范化输出使用解码后的内容
+    EXPECT_EQ(true, v == eager);
+    EXPECT_EQ(eager.GetHash(), v.GetHash());
+    std::string canonical;
+    eager.Stringify(canonical, StringifyFlag::Canonical);
+    v.Stringify(result, StringifyFlag::Canonical);
+    EXPECT_EQ(canonical, result);
+
+    // 拷贝共享解码结果；修改之后不再引用输入
+    Json copy = v.GetObjectValue(1);
+    EXPECT_EQ("a\n\xC3\xA9\xF0\x9D\x84\x9E\"", copy.GetString());
+    copy.SetString("b");
+    copy.Stringify(result);
+    EXPECT_EQ("\"b\"", result);
+
+    // 转义与 UTF-8 的错误仍然在解析时发现
+    const char *invalid[] = {"\"\\v\"", "\"\\u12\"", "\"\\uD800\"", "\"\x01\"", "\"abc", "[\"a\\\"]"};
+    for (const char *text : invalid)
+    {
+        std::string expect;
+        eager.Parse(text, expect);
+        v.Parse(text, status, ParseFlag::ZeroCopy);
+        EXPECT_EQ(expect, status) << text;
+    }
+    v.Parse("\"\\n\xE2\x82\"", status, ParseFlag::ZeroCopy | ParseFlag::StrictUTF8);
+    EXPECT_EQ("parse invalid utf8", status);
+}
+
+// 测试一个线程读取延迟解码的字符串，另一个线程同时拷贝这些字符串并读取拷贝
+TEST(TestLazyStringThreads, LazyStringThreads)
+{
+    std::string content = "[";
+    for (int i = 0; i < 2000; ++i)
+        content += std::string(i ? "," : "") + "\"v\\n" + std::to_string(i) + "\"";
+    content += "]";
+    SJson::Json v;
+    v.Parse(content, status, SJson::ParseFlag::ZeroCopy);
+    EXPECT_EQ("parse ok", status);
+    std::thread reader([&]()
+                       {
+        SJson::JsonView view(v);
+        for (size_t i = 0; i < view.GetArraySize(); ++i)
+            EXPECT_EQ("v\n" + std::to_string(i), view.GetArrayElement(i).GetString()); });
+    for (size_t i = 0; i < v.GetArraySize(); ++i)
+    {
+        SJson::Json copy = v.GetArrayElement(i);
+        EXPECT_EQ("v\n" + std::to_string(i), copy.GetString());
+    }
+    reader.join();
+    // 解码结果保存在共享的缓存中，拷贝读到的是同一份
+    SJson::JsonView view(v);
+    SJson::Json copy = v.GetArrayElement(7);
+    EXPECT_EQ(view.GetArrayElement(7).GetString().data(), SJson::JsonView(copy).GetString().data());
+}
+
 // 测试是否移动
 TEST(TestMove, Move)
 {
@@ -466,6 +1959,37 @@ TEST(TestMove, Move)
     EXPECT_EQ(1, int(v3 == v1));
 }
 
+// 测试把值移动到数组和对象中
+TEST(TestMoveInto, MoveInto)
+{
+    using namespace SJson;
+    SJson::Json arr, obj, v, expect;
+    std::string str = "hello";
+    v.SetString(std::move(str));
+    EXPECT_EQ("hello", v.GetString());
+
+    arr.SetArray();
+    arr.ReserveArray(4);
+    arr.PushbackArrayElement(std::move(v));
+    EXPECT_EQ(JsonType::Null, v.GetType());
+    v.Parse("[1,2]");
+    arr.InsertArrayElement(std::move(v), 0);
+    EXPECT_EQ(JsonType::Null, v.GetType());
+
+    obj.SetObject();
+    obj.ReserveObject(3);
+    obj.EmplaceObjectValue("a", std::move(arr));
+    EXPECT_EQ(JsonType::Null, arr.GetType());
+    v = std::string("x");
+    obj.SetObjectValue("b", std::move(v));
+    EXPECT_EQ(JsonType::Null, v.GetType());
+    v.SetNumber(3);
+    obj.SetObjectValue("b", std::move(v));
+
+    expect.Parse("{\"a\":[[1,2],\"hello\"],\"b\":3}");
+    EXPECT_EQ(1, int(obj == expect));
+}
+
 // 测试是否交换
 TEST(TestSwap, Swap)
 {
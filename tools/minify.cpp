@@ -0,0 +1,77 @@
+// 用法：SJsonMinify [-c] [input [output]]
+// 去掉 json 文本中字符串之外的空白，input 和 output 省略或者为 "-" 时使用标准输入和标准输出；-c 时先检查文本是否合法
+#include "Json.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static bool ReadAll(FILE *fp, std::string &content)
+{
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        content.append(buf, n);
+    return !ferror(fp);
+}
+
+int main(int argc, char **argv)
+{
+    bool check = false;
+    int i = 1;
+    if (i < argc && strcmp(argv[i], "-c") == 0)
+    {
+        check = true;
+        ++i;
+    }
+    if (argc - i > 2)
+    {
+        fprintf(stderr, "usage: %s [-c] [input [output]]\n", argv[0]);
+        return 2;
+    }
+    const char *input = i < argc ? argv[i] : "-";
+    const char *output = i + 1 < argc ? argv[i + 1] : "-";
+
+    FILE *in = strcmp(input, "-") == 0 ? stdin : fopen(input, "rb");
+    if (!in)
+    {
+        perror(input);
+        return 1;
+    }
+    std::string content;
+    bool ok = ReadAll(in, content);
+    if (in != stdin)
+        fclose(in);
+    if (!ok)
+    {
+        perror(input);
+        return 1;
+    }
+
+    std::string status;
+    if (check && !SJson::Json::Validate(content.data(), content.size(), status))
+    {
+        fprintf(stderr, "%s: %s\n", input, status.c_str());
+        return 1;
+    }
+    std::string result;
+    if (!SJson::Json::Minify(content.data(), content.size(), result))
+    {
+        fprintf(stderr, "%s: parse miss quotation mark\n", input);
+        return 1;
+    }
+
+    FILE *out = strcmp(output, "-") == 0 ? stdout : fopen(output, "wb");
+    if (!out)
+    {
+        perror(output);
+        return 1;
+    }
+    ok = fwrite(result.data(), 1, result.size(), out) == result.size();
+    ok = (out == stdout ? fflush(out) : fclose(out)) == 0 && ok;
+    if (!ok)
+    {
+        perror(output);
+        return 1;
+    }
+    return 0;
+}